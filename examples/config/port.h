@@ -66,7 +66,8 @@
  * This define is responsible for the maximum count of tasks
  * the operating system can manage. For example:
  * @e char = 8 bit, 8 * 8 = 64 tasks;
- * @e long = 32 bit, 32 * 32 = 1024 tasks.
+ * @e long = 32 bit, 32 * 32 = 1024 tasks;
+ * @e long long = 64 bit, 64 * 64 = 4096 tasks.
  */
 #define MVAR_t                   char
 
@@ -357,6 +358,25 @@
  */
 #define POSCFG_FBIT_BITSHIFT         1
 
+/** Generic finbit configuration, compiler builtins.
+ * If this define is set to 1 and the compiler is GCC or clang,
+ * findbit is done inline with the builtin that counts trailing
+ * zeros (one instruction on most 32 and 64 bit machines).
+ * Round robin findbit then needs one rotate and one such count.
+ * For other compilers the de Bruijn method is used instead,
+ * see ::POSCFG_FBIT_DEBRUIJN.
+ */
+#define POSCFG_FBIT_USE_BUILTIN      0
+
+/** Generic finbit configuration, de Bruijn multiplication.
+ * If this define is set to 1, findbit isolates the lowest set
+ * bit and multiplies it with a de Bruijn constant. The top bits
+ * of the product index a table of ::MVAR_BITS bytes. This needs
+ * no branches, but a fast multiplier, and ::MVAR_BITS must be
+ * 16, 32 or 64.
+ */
+#define POSCFG_FBIT_DEBRUIJN         0
+
 /** @} */
 
 
@@ -57,9 +57,25 @@
  * This define limits the maximum count of available priority levels.
  * For the round robin scheduler, the maximum count is equal to ::MVAR_BITS.
  * For the standard scheduler, the maximum count cannot exceed ::MVAR_BITS ^ 2.
+ * With ::POSCFG_TASKTABLE_LEVELS set to 3, the limits are ::MVAR_BITS ^ 2
+ * and ::MVAR_BITS ^ 3.
  */
 #define POSCFG_MAX_PRIO_LEVEL    8
 
+/** Count of bitmap levels in the task tables.
+ * The scheduler keeps the ready tasks in a bitmap table. A bitmask selects
+ * the table row, the row selects the task. With 3 levels another bitmask
+ * selects a group of ::MVAR_BITS rows, so up to ::MVAR_BITS ^ 3 tasks are
+ * possible (e.g. 32768 tasks with 32 bit). The scheduler still needs a
+ * fixed count of findbit operations, one more than with 2 levels. Each
+ * semaphore, mutex and flag object needs the same table for its waiting
+ * tasks, so the memory usage grows with ::POSCFG_MAX_PRIO_LEVEL.
+ * Allowed values are 2 and 3, and 3 needs ::MVAR_BITS of at least 16.
+ * The third level is only built when the priorities do not fit into
+ * two levels.
+ */
+#define POSCFG_TASKTABLE_LEVELS  2
+
 /** Maximum number of allowed tasks per priority level.
  * If the standard scheduler is used, this define automatically
  * defaults to 1, since the standard scheduler supports only
@@ -126,6 +142,35 @@
  */
 #define POSCFG_MAX_TIMER         4 
 
+/** Use a hierarchical timing wheel for the timers.
+ * If this definition is set to 0, all active timers are kept in a
+ * single list that is scanned on every timer tick. If it is set to 1,
+ * the timers are sorted into a hierarchical timing wheel instead.
+ * The timer interrupt then does only a constant amount of work plus the
+ * work for the timers that really expire, independent of the count of
+ * running timers. ::posTimerStart and ::posTimerStop stay O(1).
+ * The wheel costs some RAM: ::POSCFG_TIMER_WHEEL_LEVELS *
+ * 2^::POSCFG_TIMER_WHEEL_BITS pointers.
+ * If ::POSCFG_FEATURE_TIMER is set to 0, this define has no effect.
+ */
+#define POSCFG_TIMER_WHEEL       0
+
+/** Count of address bits per timing wheel level.
+ * Each level of the timing wheel has 2^POSCFG_TIMER_WHEEL_BITS slots.
+ * This define has only an effect when ::POSCFG_TIMER_WHEEL is set to 1.
+ */
+#define POSCFG_TIMER_WHEEL_BITS  4
+
+/** Count of timing wheel levels.
+ * The wheel covers timer periods of up to
+ * 2^(::POSCFG_TIMER_WHEEL_BITS * POSCFG_TIMER_WHEEL_LEVELS) ticks directly,
+ * longer periods are handled by re-sorting the timer when the highest
+ * level wraps around. The product of both defines must not exceed
+ * the bit width of the type ::UINT_t.
+ * This define has only an effect when ::POSCFG_TIMER_WHEEL is set to 1.
+ */
+#define POSCFG_TIMER_WHEEL_LEVELS  4
+
 /** Set scheduling scheme.
  * The pico]OS supports two types of scheduling:<br>
  *
@@ -207,12 +252,25 @@
 
 /** Size of message buffers in bytes.
  * If message boxes are enabled and ::POSCFG_MSG_MEMORY is set to 1,
- * this define sets the size of a message buffer. To keep the
- * operating system as simple as possible, only one fixed
- * buffer size is supported.
+ * this define sets the size of a message buffer. By default only
+ * one fixed buffer size is supported, see ::POSCFG_MSG_SIZECLASSES
+ * for buffers of different sizes.
  */
 #define POSCFG_MSG_BUFSIZE      80
 
+/** Count of message buffer size classes.
+ * If this define is set to a value greater than 1 (up to 4), there is
+ * a pool of message buffers for each size class. The first class
+ * is set up with ::POSCFG_MSG_BUFSIZE and ::POSCFG_MAX_MESSAGES,
+ * the other classes with POSCFG_MSG_BUFSIZE2 / POSCFG_MAX_MESSAGES2
+ * up to POSCFG_MSG_BUFSIZE4 / POSCFG_MAX_MESSAGES4, with increasing
+ * sizes. ::posMessageAllocSize takes a buffer from the smallest class
+ * that is large enough, and ::posMessageAlloc takes it from the first
+ * class. The buffers are still passed by reference to the receiver.
+ * Note that this requires ::POSCFG_MSG_MEMORY to be set to 1.
+ */
+#define POSCFG_MSG_SIZECLASSES   1
+
 /** Set number of software interrupts.
  * pico]OS has a built in mechanism to simulate software interrupts.
  * For example, software interrupts can be used to connect hardware
@@ -242,6 +300,37 @@
  */
 #define POSCFG_SOFTINTQUEUELEN  20
 
+/** Merge repeated software interrupts.
+ * If this define is set to 1, pending software interrupts are kept in
+ * a bitmap instead of the queue. A software interrupt that is raised
+ * again before its handler ran is executed only once, and its
+ * parameters are combined by the function set with ::posSoftIntSetMerge.
+ * No software interrupt can get lost, and ::POSCFG_SOFTINTQUEUELEN
+ * is not used.
+ * @note  The define ::POSCFG_FEATURE_SOFTINTS must be set to 1 to have
+ *        software interrupts compiled in.
+ */
+#define POSCFG_SOFTINT_COALESCE  0
+
+/** Include function ::posSoftIntDefer.
+ * If this define is set to 1, functions can be deferred to software
+ * interrupt level without an interrupt number. ::POSCFG_SOFTINTDEFERLEN
+ * sets the count of deferred calls that can be queued.
+ * @note  The define ::POSCFG_FEATURE_SOFTINTS must be set to 1 to have
+ *        software interrupts compiled in.
+ */
+#define POSCFG_FEATURE_SOFTINTDEFER  0
+#define POSCFG_SOFTINTDEFERLEN   8
+
+/** Include software interrupt statistics.
+ * If this define is set to 1, the functions ::posSoftIntDropCount and
+ * ::posSoftIntHighWater report lost software interrupts and the
+ * highest fill level of the queue.
+ * @note  The define ::POSCFG_FEATURE_SOFTINTS must be set to 1 to have
+ *        software interrupts compiled in.
+ */
+#define POSCFG_FEATURE_SOFTINTSTATS  0
+
 /** Timer tick rate.
  * This define must be set to the tickrate of the timer
  * interrupt (= timer ticks per second).
@@ -382,6 +471,47 @@
  */
 #define POSCFG_FEATURE_MUTEXTRYLOCK  1
 
+/** Enable priority inheritance for mutexes.
+ * If this definition is set to 1, a task that holds a mutex is
+ * temporarily raised to the priority of the highest priority task
+ * that is blocked on one of its mutexes. This also works through
+ * chains of nested mutexes. The original priority is restored
+ * by ::posMutexUnlock. This bounds the time a high priority task
+ * can be blocked by lower priority tasks (priority inversion).
+ * The base priority of a boosted task stays reserved, so with
+ * ::POSCFG_ROUNDROBIN set to 0 a boosted task needs a free
+ * priority slot at or above the priority of the waiting task.
+ * Note that also ::POSCFG_FEATURE_MUTEXES must be set to 1.
+ */
+#define POSCFG_MUTEX_PRIO_INHERIT    0
+
+/** Include function ::posMutexCreateCeiling.
+ * If this definition is set to 1, the function ::posMutexCreateCeiling
+ * will be included into the pico]OS kernel. It creates mutexes that
+ * raise the locking task immediately to a fixed ceiling priority.
+ * Note that also ::POSCFG_FEATURE_MUTEXES must be set to 1.
+ */
+#define POSCFG_FEATURE_MUTEXCEILING  0
+
+/** Enable condition variable support.
+ * If this definition is set to 1, the functions ::posCondCreate,
+ * ::posCondDestroy, ::posCondWait, ::posCondSignal and
+ * ::posCondBroadcast will be included into the pico]OS kernel.
+ * Each condition variable uses an event structure
+ * (see ::POSCFG_MAX_EVENTS).
+ * Note that also ::POSCFG_FEATURE_MUTEXES must be set to 1.
+ */
+#define POSCFG_FEATURE_CONDVARS      0
+
+/** Enable reader/writer lock support.
+ * If this definition is set to 1, the functions ::posRwLockCreate,
+ * ::posRwLockDestroy, ::posRwLockReadLock, ::posRwLockReadUnlock,
+ * ::posRwLockWriteLock and ::posRwLockWriteUnlock will be included
+ * into the pico]OS kernel. Each lock uses two event structures
+ * (see ::POSCFG_MAX_EVENTS).
+ */
+#define POSCFG_FEATURE_RWLOCKS       0
+
 /** Include function ::posTaskGetCurrent.
  * If this definition is set to 1, the function ::posTaskGetCurrent will
  * be included into the pico]OS kernel.
@@ -407,6 +537,26 @@
  */
 #define POSCFG_FEATURE_MSGWAIT       1
 
+/** Include support for message box limits.
+ * If this definition is set to 1, the functions ::posMessageBoxLimit,
+ * ::posMessageSendWait and ::posMessageHighWater will be included into
+ * the pico]OS kernel. A task can limit the count of messages pending
+ * in its message box, so a slow receiver blocks only the tasks that
+ * send to it and does not use up all message buffers.
+ * Note that also ::POSCFG_FEATURE_MSGBOXES must be set to 1.
+ */
+#define POSCFG_FEATURE_MSGBOXLIMIT   0
+
+/** Include functions for batches of messages.
+ * If this definition is set to 1, the functions ::posMessageSendBatch,
+ * ::posMessageGetAll, ::posMessageWaitAll and ::posMessageNext will be
+ * included into the pico]OS kernel. They move a whole chain of
+ * messages with one kernel call and one task switch.
+ * Note that also ::POSCFG_FEATURE_MSGBOXES and ::POSCFG_MSG_MEMORY
+ * must be set to 1.
+ */
+#define POSCFG_FEATURE_MSGBATCH      0
+
 /** Include functions ::posTaskSchedLock and ::posTaskSchedUnlock.
  * If this definition is set to 1, the functions ::posTaskSchedLock
  * and ::posTaskSchedUnlock will be included into the pico]OS kernel.
@@ -439,6 +589,52 @@
  */
 #define POSCFG_FEATURE_TIMERCALLBACK    1
 
+/** Include the timer daemon.
+ * If this definition is set to 1, the task function ::posTimerDaemon
+ * will be included into the pico]OS kernel. Started as a task, it runs
+ * the timer callbacks in task context instead of the timer interrupt.
+ * Note that also ::POSCFG_FEATURE_TIMER and ::POSCFG_FEATURE_TIMERCALLBACK
+ * must be set to 1.
+ */
+#define POSCFG_FEATURE_TIMERDAEMON   0
+
+/** Include the high resolution timer functions.
+ * If this definition is set to 1, the functions ::posTaskSleepNs,
+ * ::posSemaWaitNs and ::posTimerSetNs (and ::posTimerCallbackSetNs)
+ * are added to the user API. They take times in nanoseconds and are
+ * served by a one-shot compare interrupt, independent of ::HZ.
+ * The architecture port is expected to provide ::p_pos_hiresNow and
+ * ::p_pos_hiresSetCompare and to call ::c_pos_hiresInterrupt.
+ */
+#define POSCFG_FEATURE_HIRESTIMER    0
+
+/** Include the earliest-deadline-first scheduling class.
+ * If this definition is set to 1, the functions ::posTaskCreateDeadline
+ * and ::posTaskWaitNextPeriod are added to the user API. Periodic tasks
+ * created with ::posTaskCreateDeadline share the priority
+ * ::POSCFG_EDF_PRIO, and among them the task with the earliest absolute
+ * deadline runs. Normal tasks above and below this priority are
+ * scheduled as usual. Note that ::POSCFG_ROUNDROBIN,
+ * ::POSCFG_FEATURE_JIFFIES and ::POSCFG_FEATURE_SLEEP must be set to 1.
+ */
+#define POSCFG_FEATURE_EDF           0
+
+/** Priority of the EDF tasks.
+ * All tasks created with ::posTaskCreateDeadline get this priority.
+ * The priority is reserved for them, ::posTaskCreate fails for it.
+ * The value must be in the range 1 .. ::POSCFG_MAX_PRIO_LEVEL - 1.
+ */
+#define POSCFG_EDF_PRIO              1
+
+/** Include execution budgets.
+ * If this definition is set to 1, the functions ::posTaskSetBudget and
+ * ::posTaskOverrunCount are added to the user API. A task with a budget
+ * may run for a given count of timer ticks per period. When it has used
+ * up its budget, it is throttled until the next period begins.
+ * Note that also ::POSCFG_FEATURE_JIFFIES must be set to 1.
+ */
+#define POSCFG_FEATURE_BUDGET        0
+
 /** Include function ::posTimerFired.
  * If this definition is set to 1, the function ::posTimerFired will
  * be included into the pico]OS kernel. Note that also
@@ -466,6 +662,22 @@
  */
 #define POSCFG_FEATURE_FLAGWAIT      1
 
+/** Include function ::posFlagWaitMask.
+ * If this definition is set to 1, the function ::posFlagWaitMask
+ * will be included into the pico]OS kernel. It waits for any or all
+ * flags of a mask, and ::posFlagSet then wakes only the tasks whose
+ * condition is met. Note that also ::POSCFG_FEATURE_FLAGS must be
+ * set to 1.
+ */
+#define POSCFG_FEATURE_FLAGWAITMASK  0
+
+/** Include function ::posEventWaitAny.
+ * If this definition is set to 1, the function ::posEventWaitAny
+ * will be included into the pico]OS kernel. A task can then wait
+ * for several semaphores, flag objects and its message box at once.
+ */
+#define POSCFG_FEATURE_EVENTWAITANY  0
+
 /** Include software interrupt functions.
  * If this definition is set to 1, the software interrupt functions are
  * added to the user API.
@@ -516,6 +728,14 @@
  */
 #define POSCFG_FEATURE_LISTLEN       1
 
+/** Include the ring buffer functions.
+ * If this definition is set to 1, the single-producer/single-consumer
+ * ring buffer functions (::posRingCreate, ::posRingPut, ::posRingGet
+ * and ::posRingWait) are added to the user API. Each ring buffer
+ * needs one event, see ::POSCFG_MAX_EVENTS.
+ */
+#define POSCFG_FEATURE_RINGBUF       0
+
 /** Enable the debug help.
  * If this definition is set to 1, pico]OS exports the global
  * variables ::picodeb_tasklist and ::picodeb_eventlist that
@@ -519,6 +519,85 @@
 #ifndef POSCFG_POWER_WAKEUP
 #define POSCFG_POWER_WAKEUP 0
 #endif
+#ifndef POSCFG_TIMER_WHEEL
+#define POSCFG_TIMER_WHEEL 0
+#endif
+#ifndef POSCFG_TIMER_WHEEL_BITS
+#define POSCFG_TIMER_WHEEL_BITS 4
+#endif
+#ifndef POSCFG_TIMER_WHEEL_LEVELS
+#define POSCFG_TIMER_WHEEL_LEVELS 4
+#endif
+#ifndef POSCFG_MUTEX_PRIO_INHERIT
+#define POSCFG_MUTEX_PRIO_INHERIT 0
+#endif
+#ifndef POSCFG_FEATURE_MUTEXCEILING
+#define POSCFG_FEATURE_MUTEXCEILING 0
+#endif
+#ifndef POSCFG_TASKTABLE_LEVELS
+#define POSCFG_TASKTABLE_LEVELS 2
+#endif
+#ifndef POSCFG_FEATURE_CONDVARS
+#define POSCFG_FEATURE_CONDVARS 0
+#endif
+#ifndef POSCFG_FEATURE_RWLOCKS
+#define POSCFG_FEATURE_RWLOCKS 0
+#endif
+#ifndef POSCFG_FEATURE_EVENTWAITANY
+#define POSCFG_FEATURE_EVENTWAITANY 0
+#endif
+#ifndef POSCFG_FEATURE_FLAGWAITMASK
+#define POSCFG_FEATURE_FLAGWAITMASK 0
+#endif
+#ifndef POSCFG_MSG_SIZECLASSES
+#define POSCFG_MSG_SIZECLASSES 1
+#endif
+#ifndef POSCFG_FEATURE_MSGBOXLIMIT
+#define POSCFG_FEATURE_MSGBOXLIMIT 0
+#endif
+#ifndef POSCFG_FEATURE_MSGBATCH
+#define POSCFG_FEATURE_MSGBATCH 0
+#endif
+#ifndef POSCFG_FEATURE_RINGBUF
+#define POSCFG_FEATURE_RINGBUF 0
+#endif
+#ifndef POSCFG_SOFTINT_COALESCE
+#define POSCFG_SOFTINT_COALESCE 0
+#endif
+#ifndef POSCFG_FEATURE_SOFTINTDEFER
+#define POSCFG_FEATURE_SOFTINTDEFER 0
+#endif
+#ifndef POSCFG_SOFTINTDEFERLEN
+#define POSCFG_SOFTINTDEFERLEN 8
+#endif
+#ifndef POSCFG_FEATURE_SOFTINTSTATS
+#define POSCFG_FEATURE_SOFTINTSTATS 0
+#endif
+#ifndef POSCFG_FEATURE_TIMERDAEMON
+#define POSCFG_FEATURE_TIMERDAEMON 0
+#endif
+#ifndef POSCFG_FEATURE_HIRESTIMER
+#define POSCFG_FEATURE_HIRESTIMER 0
+#endif
+#ifndef POSCFG_FEATURE_EDF
+#define POSCFG_FEATURE_EDF 0
+#endif
+#ifndef POSCFG_EDF_PRIO
+#define POSCFG_EDF_PRIO 1
+#endif
+#ifndef POSCFG_FEATURE_BUDGET
+#define POSCFG_FEATURE_BUDGET 0
+#endif
+/* Orders the memory accesses of the lock-free ring buffer. A compiler
+ * barrier is enough on a single core, a port for a multi core CPU
+ * defines a real memory barrier in port.h. */
+#ifndef POS_MEMORY_BARRIER
+#ifdef __GNUC__
+#define POS_MEMORY_BARRIER()  __asm__ __volatile__ ("" ::: "memory")
+#else
+#define POS_MEMORY_BARRIER()  do { } while(0)
+#endif
+#endif
 
 /* parameter range checking */
 #if (POSCFG_DYNAMIC_MEMORY != 0) && (POSCFG_DYNAMIC_REFILL != 0)
@@ -526,18 +605,96 @@
 #else
 #define SYS_POSTALLOCATE    0
 #endif
-#if (MVAR_BITS != 8) && (MVAR_BITS != 16) && (MVAR_BITS != 32)
-#error MVAR_BITS must be 8, 16 or 32
+#if (MVAR_BITS != 8) && (MVAR_BITS != 16) && (MVAR_BITS != 32) && \
+    (MVAR_BITS != 64)
+#error MVAR_BITS must be 8, 16, 32 or 64
 #endif
 #if POSCFG_MAX_PRIO_LEVEL == 0
 #error POSCFG_MAX_PRIO_LEVEL must not be zero
 #endif
+#if (POSCFG_TIMER_WHEEL != 0) && \
+    ((POSCFG_TIMER_WHEEL_BITS < 1) || (POSCFG_TIMER_WHEEL_LEVELS < 1))
+#error POSCFG_TIMER_WHEEL_BITS and POSCFG_TIMER_WHEEL_LEVELS must be at least 1
+#endif
+#if POSCFG_TIMER_WHEEL != 0
+/* The wheel selects its slots by shifting a UINT_t. The bit width
+ * of UINT_t is MINT_BITS, or that of int if MINT_t is not changed.
+ */
+#if defined(MINT_BITS)
+#define SYS_UINT_BITS  MINT_BITS
+#elif !defined(MINT_t)
+#include <limits.h>
+#if UINT_MAX > 0xFFFFFFFFUL
+#define SYS_UINT_BITS  64
+#elif UINT_MAX > 0xFFFFUL
+#define SYS_UINT_BITS  32
+#else
+#define SYS_UINT_BITS  16
+#endif
+#else
+#error MINT_BITS must be set to the bit width of MINT_t
+#endif
+#if (POSCFG_TIMER_WHEEL_BITS * POSCFG_TIMER_WHEEL_LEVELS) > SYS_UINT_BITS
+#error POSCFG_TIMER_WHEEL_BITS * POSCFG_TIMER_WHEEL_LEVELS must not exceed the bit width of UINT_t
+#endif
+#endif
+#if (POSCFG_MUTEX_PRIO_INHERIT != 0) && (POSCFG_FEATURE_MUTEXES == 0)
+#error POSCFG_MUTEX_PRIO_INHERIT requires POSCFG_FEATURE_MUTEXES
+#endif
+#if (POSCFG_FEATURE_MUTEXCEILING != 0) && (POSCFG_FEATURE_MUTEXES == 0)
+#error POSCFG_FEATURE_MUTEXCEILING requires POSCFG_FEATURE_MUTEXES
+#endif
+#if (POSCFG_FEATURE_CONDVARS != 0) && (POSCFG_FEATURE_MUTEXES == 0)
+#error POSCFG_FEATURE_CONDVARS requires POSCFG_FEATURE_MUTEXES
+#endif
+#if (POSCFG_FEATURE_FLAGWAITMASK != 0) && (POSCFG_FEATURE_FLAGS == 0)
+#error POSCFG_FEATURE_FLAGWAITMASK requires POSCFG_FEATURE_FLAGS
+#endif
+#if (POSCFG_FEATURE_MSGBOXLIMIT != 0) && (POSCFG_FEATURE_MSGBOXES == 0)
+#error POSCFG_FEATURE_MSGBOXLIMIT requires POSCFG_FEATURE_MSGBOXES
+#endif
+#if (POSCFG_FEATURE_MSGBATCH != 0) && \
+    ((POSCFG_FEATURE_MSGBOXES == 0) || (POSCFG_MSG_MEMORY == 0))
+#error POSCFG_FEATURE_MSGBATCH requires POSCFG_FEATURE_MSGBOXES and POSCFG_MSG_MEMORY
+#endif
+#if (POSCFG_FEATURE_TIMERDAEMON != 0) && \
+    ((POSCFG_FEATURE_TIMER == 0) || (POSCFG_FEATURE_TIMERCALLBACK == 0))
+#error POSCFG_FEATURE_TIMERDAEMON requires POSCFG_FEATURE_TIMER and POSCFG_FEATURE_TIMERCALLBACK
+#endif
+#if (POSCFG_FEATURE_EDF != 0) && \
+    ((POSCFG_ROUNDROBIN == 0) || (POSCFG_FEATURE_JIFFIES == 0) || \
+     (POSCFG_FEATURE_SLEEP == 0))
+#error POSCFG_FEATURE_EDF requires POSCFG_ROUNDROBIN, POSCFG_FEATURE_JIFFIES and POSCFG_FEATURE_SLEEP
+#endif
+#if (POSCFG_FEATURE_EDF != 0) && \
+    ((POSCFG_EDF_PRIO < 1) || (POSCFG_EDF_PRIO >= POSCFG_MAX_PRIO_LEVEL))
+#error POSCFG_EDF_PRIO must be in the range 1 .. POSCFG_MAX_PRIO_LEVEL - 1
+#endif
+#if (POSCFG_FEATURE_BUDGET != 0) && (POSCFG_FEATURE_JIFFIES == 0)
+#error POSCFG_FEATURE_BUDGET requires POSCFG_FEATURE_JIFFIES
+#endif
+#if (POSCFG_TASKTABLE_LEVELS != 2) && (POSCFG_TASKTABLE_LEVELS != 3)
+#error POSCFG_TASKTABLE_LEVELS must be 2 or 3
+#endif
+#if (POSCFG_TASKTABLE_LEVELS == 3) && (MVAR_BITS < 16)
+#error POSCFG_TASKTABLE_LEVELS 3 needs MVAR_BITS of at least 16
+#endif
+#if POSCFG_TASKTABLE_LEVELS == 2
 #if (POSCFG_ROUNDROBIN != 0) && (POSCFG_MAX_PRIO_LEVEL > MVAR_BITS)
 #error POSCFG_MAX_PRIO_LEVEL must not exceed MVAR_BITS
 #endif 
 #if (POSCFG_ROUNDROBIN == 0) && (POSCFG_MAX_PRIO_LEVEL > (MVAR_BITS*MVAR_BITS))
 #error POSCFG_MAX_PRIO_LEVEL must not exceed (MVAR_BITS * MVAR_BITS)
 #endif 
+#else
+#if (POSCFG_ROUNDROBIN != 0) && (POSCFG_MAX_PRIO_LEVEL > (MVAR_BITS*MVAR_BITS))
+#error POSCFG_MAX_PRIO_LEVEL must not exceed (MVAR_BITS * MVAR_BITS)
+#endif 
+#if (POSCFG_ROUNDROBIN == 0) && \
+    (POSCFG_MAX_PRIO_LEVEL > (MVAR_BITS*MVAR_BITS*MVAR_BITS))
+#error POSCFG_MAX_PRIO_LEVEL must not exceed (MVAR_BITS ^ 3)
+#endif 
+#endif
 #if (POSCFG_MAX_TASKS < 2) && (SYS_POSTALLOCATE == 0)
 #error POSCFG_MAX_TASKS is less than 2
 #endif
@@ -569,6 +726,33 @@
 #if POSCFG_MSG_BUFSIZE < 1
 #error POSCFG_MSG_BUFSIZE must be at least 1
 #endif
+#if (POSCFG_MSG_SIZECLASSES < 1) || (POSCFG_MSG_SIZECLASSES > 4)
+#error POSCFG_MSG_SIZECLASSES must be in the range 1 .. 4
+#endif
+#if POSCFG_MSG_SIZECLASSES > 1
+#if POSCFG_MSG_MEMORY == 0
+#error POSCFG_MSG_SIZECLASSES requires POSCFG_MSG_MEMORY
+#endif
+#if !defined(POSCFG_MSG_BUFSIZE2) || !defined(POSCFG_MAX_MESSAGES2)
+#error POSCFG_MSG_BUFSIZE2 / POSCFG_MAX_MESSAGES2 not defined
+#elif POSCFG_MSG_BUFSIZE2 <= POSCFG_MSG_BUFSIZE
+#error POSCFG_MSG_BUFSIZE2 must be greater than POSCFG_MSG_BUFSIZE
+#endif
+#endif
+#if POSCFG_MSG_SIZECLASSES > 2
+#if !defined(POSCFG_MSG_BUFSIZE3) || !defined(POSCFG_MAX_MESSAGES3)
+#error POSCFG_MSG_BUFSIZE3 / POSCFG_MAX_MESSAGES3 not defined
+#elif POSCFG_MSG_BUFSIZE3 <= POSCFG_MSG_BUFSIZE2
+#error POSCFG_MSG_BUFSIZE3 must be greater than POSCFG_MSG_BUFSIZE2
+#endif
+#endif
+#if POSCFG_MSG_SIZECLASSES > 3
+#if !defined(POSCFG_MSG_BUFSIZE4) || !defined(POSCFG_MAX_MESSAGES4)
+#error POSCFG_MSG_BUFSIZE4 / POSCFG_MAX_MESSAGES4 not defined
+#elif POSCFG_MSG_BUFSIZE4 <= POSCFG_MSG_BUFSIZE3
+#error POSCFG_MSG_BUFSIZE4 must be greater than POSCFG_MSG_BUFSIZE3
+#endif
+#endif
 #endif
 #if (POSCFG_FEATURE_TIMER != 0)
 #if (POSCFG_MAX_TIMER == 0) && (SYS_POSTALLOCATE == 0)
@@ -593,6 +777,14 @@
 #if POSCFG_SOFTINTQUEUELEN < 2
 #error POSCFG_SOFTINTQUEUELEN must be at least 2
 #endif
+#if (POSCFG_FEATURE_SOFTINTDEFER != 0) && (POSCFG_SOFTINTDEFERLEN < 2)
+#error POSCFG_SOFTINTDEFERLEN must be at least 2
+#endif
+#else
+#if (POSCFG_SOFTINT_COALESCE != 0) || (POSCFG_FEATURE_SOFTINTDEFER != 0) || \
+    (POSCFG_FEATURE_SOFTINTSTATS != 0)
+#error software interrupt options require POSCFG_FEATURE_SOFTINTS
+#endif
 #endif
 
 
@@ -618,7 +810,7 @@
 #endif
 #endif
 #if (POSCFG_FEATURE_MSGBOXES != 0) && (SYS_POSTALLOCATE == 0)
-#define SYS_MSGBOXEVENTS  2
+#define SYS_MSGBOXEVENTS  (2 * POSCFG_MSG_SIZECLASSES)
 #else
 #define SYS_MSGBOXEVENTS  0
 #endif
@@ -626,18 +818,24 @@
 #undef POSCFG_FEATURE_GETTASK
 #define POSCFG_FEATURE_GETTASK 1
 #endif
-#if (POSCFG_FEATURE_SEMAWAIT != 0) || (POSCFG_FEATURE_MSGWAIT != 0)
+#if (POSCFG_FEATURE_SEMAWAIT != 0) || (POSCFG_FEATURE_MSGWAIT != 0) || \
+    ((POSCFG_FEATURE_FLAGS != 0) && (POSCFG_FEATURE_FLAGWAIT != 0)) || \
+    (POSCFG_FEATURE_CONDVARS != 0) || (POSCFG_FEATURE_EVENTWAITANY != 0) || \
+    (POSCFG_FEATURE_FLAGWAITMASK != 0) || (POSCFG_FEATURE_MSGBOXLIMIT != 0) || \
+    (POSCFG_FEATURE_MSGBATCH != 0)
 #define SYS_TASKDOUBLELINK  1
 #else
 #define SYS_TASKDOUBLELINK  0
 #endif
 #define SYS_EVENTS_USED  \
       (POSCFG_FEATURE_MUTEXES | POSCFG_FEATURE_MSGBOXES | \
-       POSCFG_FEATURE_FLAGS | POSCFG_FEATURE_LISTS)
+       POSCFG_FEATURE_FLAGS | POSCFG_FEATURE_LISTS | POSCFG_FEATURE_RWLOCKS | \
+       POSCFG_FEATURE_EVENTWAITANY | POSCFG_FEATURE_RINGBUF)
 #define SYS_FEATURE_EVENTS  (POSCFG_FEATURE_SEMAPHORES | SYS_EVENTS_USED)
 #define SYS_FEATURE_EVENTFREE  (POSCFG_FEATURE_SEMADESTROY | \
           POSCFG_FEATURE_MUTEXDESTROY | POSCFG_FEATURE_FLAGDESTROY | \
-          POSCFG_FEATURE_LISTS)
+          POSCFG_FEATURE_LISTS | POSCFG_FEATURE_CONDVARS | \
+          POSCFG_FEATURE_RWLOCKS | POSCFG_FEATURE_RINGBUF)
 #if (POSCFG_FEATURE_MSGBOXES != 0) && (POSCFG_FEATURE_EXIT != 0)
 #undef  SYS_FEATURE_EVENTFREE
 #define SYS_FEATURE_EVENTFREE  1
@@ -652,7 +850,12 @@
 #ifndef POSCALL
 #define POSCALL
 #endif
-#if POSCFG_FEATURE_SETPRIORITY != 0
+#if (POSCFG_MUTEX_PRIO_INHERIT != 0) || (POSCFG_FEATURE_MUTEXCEILING != 0)
+#define SYS_MUTEXBOOST     1
+#else
+#define SYS_MUTEXBOOST     0
+#endif
+#if (POSCFG_FEATURE_SETPRIORITY != 0) || (SYS_MUTEXBOOST != 0)
 #define SYS_TASKEVENTLINK  1
 #else
 #define SYS_TASKEVENTLINK  0
@@ -681,6 +884,11 @@
 #define SYS_TASKTABSIZE_X  POSCFG_TASKS_PER_PRIO
 #define SYS_TASKTABSIZE_Y  POSCFG_MAX_PRIO_LEVEL
 #endif
+#if (POSCFG_TASKTABLE_LEVELS > 2) && (SYS_TASKTABSIZE_Y > MVAR_BITS)
+#define SYS_TASKTABSIZE_Z  ((SYS_TASKTABSIZE_Y+MVAR_BITS-1)/MVAR_BITS)
+#else
+#define SYS_TASKTABSIZE_Z  1
+#endif
 
 #define SYS_TASKSTATE (POSCFG_FEATURE_TASKUNUSED | POSCFG_FEATURE_MSGBOXES)
 
@@ -794,7 +1002,8 @@ typedef signed MINT_t     INT_t;
  *
  * The bit size can be changed by the user
  * by defining MINT_t to something other than @e int
- * in the pico]OS configuration file.
+ * in the pico]OS configuration file. With ::POSCFG_TIMER_WHEEL,
+ * MINT_BITS must then be set to the bit width of MINT_t.
  * This integer type is used by the operating system e.g.
  * for semaphore counters and timer.
  * @sa INT_t
@@ -831,6 +1040,20 @@ typedef INT_t             SJIF_t;
 typedef UINT_t            JIF_t;
 #endif
 
+#if (DOX!=0) || (POSCFG_FEATURE_HIRESTIMER != 0)
+#ifndef MNSEC_t
+#define MNSEC_t long long
+#endif
+/** @brief  High resolution time in nanoseconds.
+ * This type holds the value of the free running high resolution
+ * counter (see ::p_pos_hiresNow) and the nanosecond timeouts.
+ * ::MNSEC_t can be set in the port configuration file,
+ * it defaults to @e long long.
+ * @sa POSCFG_FEATURE_HIRESTIMER
+ */
+typedef unsigned MNSEC_t  NSEC_t;
+#endif
+
 /** @brief  Generic function pointer.
  * @param arg  optional argument, can be NULL if not used.
  */
@@ -844,6 +1067,24 @@ typedef void (*POSTASKFUNC_t)(void* arg);
  */
 typedef void (*POSINTFUNC_t)(UVAR_t arg);
 
+#if (DOX!=0) || (POSCFG_SOFTINT_COALESCE != 0)
+/** @brief  Software interrupt parameter merge function pointer.
+ *
+ * Combines the parameter @e oldparam of a pending software interrupt
+ * with the parameter @e newparam of a new ::posSoftInt call, and
+ * returns the parameter the handler will get.
+ * @sa posSoftIntSetMerge
+ */
+typedef UVAR_t (*POSSINTMERGEFUNC_t)(UVAR_t oldparam, UVAR_t newparam);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_SOFTINTDEFER != 0)
+/** @brief  Deferred function pointer.
+ * @sa posSoftIntDefer
+ */
+typedef void (*POSDEFERFUNC_t)(void *arg);
+#endif
+
 #if (DOX!=0) ||(POSCFG_FEATURE_IDLETASKHOOK != 0)
 /** @brief  Idle task function pointer */
 typedef void (*POSIDLEFUNC_t)(void);
@@ -862,6 +1103,8 @@ typedef void (*POSPOWERCB_t)(UVAR_t event);
 struct POSSEMA;
 struct POSMUTEX;
 struct POSFLAG;
+struct POSCOND;
+struct POSRWLOCK;
 struct POSTIMER;
 
 /** @brief  Handle to a semaphore object.
@@ -879,6 +1122,16 @@ typedef struct POSMUTEX *POSMUTEX_t;
  */
 typedef struct POSFLAG *POSFLAG_t;
 
+/** @brief  Handle to a condition variable object.
+ * @sa posCondCreate, posCondWait, posCondSignal, posCondBroadcast
+ */
+typedef struct POSCOND *POSCOND_t;
+
+/** @brief  Handle to a reader/writer lock object.
+ * @sa posRwLockCreate, posRwLockReadLock, posRwLockWriteLock
+ */
+typedef struct POSRWLOCK *POSRWLOCK_t;
+
 /** @brief  Handle to a timer object.
  * @sa posTimerCreate, posTimerDestroy, posTimerSet, posTimerCallbackSet, posTimerStart
  */
@@ -924,6 +1177,24 @@ typedef struct POSLIST POSLIST_t;
 typedef struct POSLISTHEAD POSLISTHEAD_t;
 #endif
 
+#if (DOX!=0) || (POSCFG_FEATURE_RINGBUF != 0)
+struct POSRING {
+  UVAR_t          volatile  head;
+  UVAR_t          volatile  tail;
+  UVAR_t          volatile  flag;
+  UVAR_t                    mask;
+  UINT_t                    esize;
+  unsigned char            *buf;
+  POSSEMA_t                 sema;
+};
+/** @brief  Ring buffer variable.
+ * This variable holds the state of a single-producer/single-consumer
+ * ring buffer.
+ * @sa posRingCreate, posRingPut, posRingGet, posRingWait
+ */
+typedef struct POSRING POSRING_t;
+#endif
+
 
 /** @brief  Task environment structure.
  *
@@ -959,8 +1230,35 @@ typedef struct POSTASK  *POSTASK_t; /* forward declaration */
 #undef POSCFG_FBIT_USE_LUTABLE
 #define POSCFG_FBIT_USE_LUTABLE 1
 #endif
+#ifndef POSCFG_FBIT_USE_BUILTIN
+#define POSCFG_FBIT_USE_BUILTIN  0
+#endif
+#ifndef POSCFG_FBIT_DEBRUIJN
+#define POSCFG_FBIT_DEBRUIJN  0
+#endif
+#define SYS_FBIT_BUILTIN  0
 #ifndef FINDBIT
-#if POSCFG_FBIT_USE_LUTABLE == 1
+#if (POSCFG_FBIT_USE_BUILTIN != 0) && (POSCFG_FBIT_USE_LUTABLE == 0) && \
+    defined(__GNUC__)
+#undef  SYS_FBIT_BUILTIN
+#define SYS_FBIT_BUILTIN  1
+#if MVAR_BITS > 32
+#define POS_CTZ(x)  ((UVAR_t) __builtin_ctzll(x))
+#else
+#define POS_CTZ(x)  ((UVAR_t) __builtin_ctz(x))
+#endif
+#if POSCFG_ROUNDROBIN == 0
+#define FINDBIT(x, o)  POS_CTZ(x)
+#else
+static __inline__ UVAR_t pos_findbitRR(UVAR_t bf, UVAR_t o)
+{
+  /* rotate right by o, the compiler turns this into one instruction */
+  bf = (bf >> o) | (bf << ((MVAR_BITS - o) & (MVAR_BITS - 1)));
+  return (POS_CTZ(bf) + o) & (MVAR_BITS - 1);
+}
+#define FINDBIT(x, o)  pos_findbitRR(x, o)
+#endif
+#elif POSCFG_FBIT_USE_LUTABLE == 1
 #if POSCFG_ROUNDROBIN == 0
 #ifndef _FBIT_GEN_C
 extern VAR_t const p_pos_fbittbl[256];
@@ -1581,10 +1879,30 @@ POSEXTERN void POSCALL c_pos_timerStep(UVAR_t ticks);      /* picoos.c */
 /**
  * Task function.
  * Return number of ticks until next task should wake up.
+ * The kernel keeps the timers and sleeping tasks sorted by their
+ * expiry, so this function only needs to look at the list heads.
  * @return  Number of ticks system can safely sleep or INFINITE.
+ * @sa      c_pos_nextWakeupJiffies
  */
 POSEXTERN UINT_t POSCALL c_pos_nextWakeup(void);
 
+#if (DOX!=0) || POSCFG_FEATURE_JIFFIES == 1
+/**
+ * Task function.
+ * Return the absolute time (in ::jiffies) when the next task or timer
+ * must be woken up. The time is calculated from the same snapshot of the
+ * jiffies counter, so it does not drift when the caller is interrupted.
+ * This is useful for ports that program a one-shot hardware timer
+ * to an absolute compare value.
+ * @param   wakeup  pointer to a variable that receives the wakeup time.
+ * @return  1 when a wakeup time was stored to *wakeup,
+ *          0 when nothing is pending (the system can sleep infinitely).
+ * @note    ::POSCFG_FEATURE_JIFFIES must be defined to 1.
+ * @sa      c_pos_nextWakeup
+ */
+POSEXTERN UVAR_t POSCALL c_pos_nextWakeupJiffies(JIF_t *wakeup);
+#endif
+
 #endif
 
 #if (DOX!=0) || POSCFG_FEATURE_POWER == 1
@@ -1635,6 +1953,45 @@ POSFROMEXT void POSCALL p_pos_powerTickResume(void);
 
 #endif
 
+#if (DOX!=0) || (POSCFG_FEATURE_HIRESTIMER != 0)
+/**
+ * Interrupt control function.
+ * This function must be called from the interrupt service routine
+ * of the high resolution compare (see ::p_pos_hiresSetCompare),
+ * between ::c_pos_intEnter and ::c_pos_intExit. It wakes all tasks
+ * and fires all timers whose nanosecond deadline has passed, and
+ * programs the compare for the next deadline. A spurious call
+ * does no harm.
+ * @note    ::POSCFG_FEATURE_HIRESTIMER must be defined to 1.
+ * @sa      p_pos_hiresNow, p_pos_hiresSetCompare, c_pos_timerInterrupt
+ */
+POSEXTERN void POSCALL c_pos_hiresInterrupt(void);      /* picoos.c */
+
+/**
+ * Returns the current value of a free running high resolution counter,
+ * converted to nanoseconds. The counter must not stop or go backwards
+ * while the system runs, its start value does not matter.
+ * @note    This function is not part of the pico]OS. It must be
+ *          provided by the user, since it is architecture specific.
+ * @sa      p_pos_hiresSetCompare, c_pos_hiresInterrupt
+ */
+POSFROMEXT NSEC_t POSCALL p_pos_hiresNow(void);          /* arch_c.c */
+
+/**
+ * Programs the one-shot compare of the high resolution counter.
+ * When the counter (see ::p_pos_hiresNow) reaches the deadline, the
+ * port raises an interrupt that calls ::c_pos_hiresInterrupt. A new
+ * value replaces the last one. If the deadline has already passed,
+ * the interrupt must be raised as soon as possible.
+ * The function is called with the scheduler locked.
+ * @note    This function is not part of the pico]OS. It must be
+ *          provided by the user, since it is architecture specific.
+ * @sa      p_pos_hiresNow, c_pos_hiresInterrupt
+ */
+POSFROMEXT void POSCALL p_pos_hiresSetCompare(NSEC_t deadline); /* arch_c.c */
+
+#endif
+
 /** @} */
 
 
@@ -1678,6 +2035,22 @@ POSEXTERN void POSCALL posTaskYield(void);
 POSEXTERN void POSCALL posTaskSleep(UINT_t ticks);
 #endif
 
+#if (DOX!=0) || ((POSCFG_FEATURE_SLEEP != 0) && (POSCFG_FEATURE_HIRESTIMER != 0))
+/**
+ * Task function.
+ * Delay task execution for a number of nanoseconds. Unlike
+ * ::posTaskSleep, the task is woken by the high resolution compare
+ * interrupt of the port, so the delay does not depend on ::HZ.
+ * @param   ns  delay time in nanoseconds. Zero only yields the processor.
+ * @note    ::POSCFG_FEATURE_SLEEP and ::POSCFG_FEATURE_HIRESTIMER
+ *          must be defined to 1 to have this function compiled in.@n
+ *          The resolution is limited by the port and by the
+ *          interrupt latency.
+ * @sa      posTaskSleep, p_pos_hiresNow
+ */
+POSEXTERN void POSCALL posTaskSleepNs(NSEC_t ns);
+#endif
+
 #if (DOX!=0) || (POSCFG_TASKSTACKTYPE == 0)
 /**
  * Task function.
@@ -1797,6 +2170,108 @@ POSEXTERN void POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg,
 
 #endif
 
+#if (DOX!=0) || (POSCFG_FEATURE_EDF != 0)
+/**
+ * Task function.
+ * Creates a new periodic task in the earliest-deadline-first class.
+ * All EDF tasks share the priority ::POSCFG_EDF_PRIO. Among them the
+ * scheduler runs the ready task with the earliest absolute deadline.
+ * Tasks of higher priority preempt EDF tasks as usual. The priority
+ * ::POSCFG_EDF_PRIO is reserved for EDF tasks, ::posTaskCreate and
+ * ::posTaskSetPriority reject it for normal tasks. A normal task gets
+ * there only while a mutex raises its priority, it then runs before
+ * the EDF tasks. The first period starts when the task is created.
+ * At the end of each job the task calls ::posTaskWaitNextPeriod.
+ * @param   funcptr     pointer to the function that shall be executed
+ *                      by the new task.
+ * @param   funcarg     optional argument passed to function.
+ * @param   period      period of the task in timer ticks. Must not be 0.
+ * @param   deadline    relative deadline in timer ticks, counted from
+ *                      the start of each period. Must not exceed the
+ *                      period. 0 sets the deadline to the period.
+ * @param   stackstart  pointer to the stack memory for the new task
+ *                      (::POSCFG_TASKSTACKTYPE 0), or the size of the
+ *                      stack memory (::POSCFG_TASKSTACKTYPE 1). With
+ *                      ::POSCFG_TASKSTACKTYPE 2 this parameter is left out.
+ * @return  handle to the task. NULL is returned when the
+ *          task could not be created.
+ * @note    ::POSCFG_FEATURE_EDF must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posTaskWaitNextPeriod, posTaskCreate
+ */
+#if (DOX!=0) || (POSCFG_TASKSTACKTYPE == 0)
+POSEXTERN POSTASK_t POSCALL posTaskCreateDeadline(POSTASKFUNC_t funcptr,
+                                                  void *funcarg,
+                                                  UINT_t period,
+                                                  UINT_t deadline,
+                                                  void *stackstart);
+#elif POSCFG_TASKSTACKTYPE == 1
+POSEXTERN POSTASK_t POSCALL posTaskCreateDeadline(POSTASKFUNC_t funcptr,
+                                                  void *funcarg,
+                                                  UINT_t period,
+                                                  UINT_t deadline,
+                                                  UINT_t stacksize);
+#else
+POSEXTERN POSTASK_t POSCALL posTaskCreateDeadline(POSTASKFUNC_t funcptr,
+                                                  void *funcarg,
+                                                  UINT_t period,
+                                                  UINT_t deadline);
+#endif
+
+/**
+ * Task function.
+ * Ends the current job of an EDF task and sleeps until the next period
+ * starts. The absolute deadline of the task moves on by one period.
+ * When the task is already late, periods whose deadline has passed
+ * are skipped and the next job starts at once.
+ * @return  0 when the job finished in time, 1 when it missed its
+ *          deadline. -E_FORB is returned when the calling task
+ *          was not created by ::posTaskCreateDeadline.
+ * @note    ::POSCFG_FEATURE_EDF must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posTaskCreateDeadline
+ */
+POSEXTERN VAR_t POSCALL posTaskWaitNextPeriod(void);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_BUDGET != 0)
+/**
+ * Task function.
+ * Sets the execution budget of a task. The task may run for
+ * @e budget timer ticks in each period of @e period ticks. The tick
+ * interrupt charges the running task one tick. When the budget is
+ * used up, the task is throttled: it is taken off the ready list
+ * until the next period starts and the budget is refilled. So a
+ * runaway task can no longer starve the tasks of lower priority.
+ * @param   taskhandle  handle to the task.
+ * @param   budget      budget in timer ticks per period.
+ *                      0 removes the budget, the task runs unlimited.
+ * @param   period      length of the period in timer ticks.
+ *                      The first period starts now.
+ * @return  zero on success. -E_ARG is returned when the budget
+ *          exceeds the period.
+ * @note    ::POSCFG_FEATURE_BUDGET must be defined to 1
+ *          to have this function compiled in.@n
+ *          A throttled task that holds a mutex keeps it until it
+ *          runs again, tasks waiting for the mutex are blocked so long.
+ * @sa      posTaskOverrunCount
+ */
+POSEXTERN VAR_t POSCALL posTaskSetBudget(POSTASK_t taskhandle,
+                                         UINT_t budget, UINT_t period);
+
+/**
+ * Task function.
+ * Returns how often a task used up its execution budget and was
+ * throttled (see ::posTaskSetBudget).
+ * @param   taskhandle  handle to the task.
+ * @return  count of budget overruns.
+ * @note    ::POSCFG_FEATURE_BUDGET must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posTaskSetBudget
+ */
+POSEXTERN UINT_t POSCALL posTaskOverrunCount(POSTASK_t taskhandle);
+#endif
+
 
 #if (DOX!=0) || (POSCFG_FEATURE_EXIT != 0)
 /**
@@ -1847,6 +2322,8 @@ POSEXTERN VAR_t POSCALL posTaskUnused(POSTASK_t taskhandle);
  * @param   priority    new priority. Must be in the range
  *                      0 .. ::POSCFG_MAX_PRIO_LEVEL - 1.
  *                      The higher the number, the higher the priority.
+ *                      With ::POSCFG_FEATURE_EDF, ::POSCFG_EDF_PRIO
+ *                      is only accepted for EDF tasks.
  * @return  zero on success.
  * @note    ::POSCFG_FEATURE_SETPRIORITY must be defined to 1 
  *          to have this function compiled in.
@@ -2090,6 +2567,23 @@ POSEXTERN VAR_t POSCALL posSemaSignal(POSSEMA_t sema);
 POSEXTERN VAR_t POSCALL posSemaWait(POSSEMA_t sema, UINT_t timeoutticks);
 #endif
 
+#if (DOX!=0) || ((POSCFG_FEATURE_SEMAWAIT != 0) && (POSCFG_FEATURE_HIRESTIMER != 0))
+/**
+ * Semaphore function.
+ * Same as ::posSemaWait, but the timeout is given in nanoseconds
+ * and is served by the high resolution compare interrupt.
+ * @param   sema  handle to the semaphore object.
+ * @param   timeoutns  timeout in nanoseconds. If this parameter is
+ *          set to zero, the function immediately returns.
+ * @return  zero on success. A positive value (1 or TRUE) is returned
+ *          when the timeout was reached.
+ * @note    ::POSCFG_FEATURE_SEMAWAIT and ::POSCFG_FEATURE_HIRESTIMER
+ *          must be defined to 1 to have this function compiled in.
+ * @sa      posSemaWait, posSemaSignal, p_pos_hiresNow
+ */
+POSEXTERN VAR_t POSCALL posSemaWaitNs(POSSEMA_t sema, NSEC_t timeoutns);
+#endif
+
 #endif /* SYS_FEATURE_EVENTS */
 /** @} */
 
@@ -2119,6 +2613,32 @@ POSEXTERN VAR_t POSCALL posSemaWait(POSSEMA_t sema, UINT_t timeoutticks);
  */
 POSEXTERN POSMUTEX_t POSCALL posMutexCreate(void);
 
+#if (DOX!=0) || (POSCFG_FEATURE_MUTEXCEILING != 0)
+/**
+ * Mutex function.
+ * Allocates a new mutex object that uses the immediate priority
+ * ceiling protocol: A task that locks the mutex is raised to the
+ * ceiling priority at once, and falls back to its own priority when
+ * it unlocks the mutex. When the ceiling is at least the priority of
+ * the highest task that uses the mutex, no other user of the mutex
+ * can run while it is locked, so the lock is taken without
+ * contention and a task is blocked for at most one critical section.
+ * @param   priority  ceiling priority of the mutex.
+ * @return  the pointer to the new mutex object. NULL is returned on error.
+ * @note    ::POSCFG_FEATURE_MUTEXCEILING must be defined to 1 
+ *          to have this function compiled in.@n
+ *          With ::POSCFG_ROUNDROBIN set to 1, tasks at the ceiling
+ *          priority itself still share the CPU with the lock holder.
+ *          With ::POSCFG_ROUNDROBIN set to 0, the lock holder runs at
+ *          the first free priority at or above the ceiling.@n
+ *          The mutex must not be locked by a task that blocks while
+ *          it holds the lock, or other users of the mutex will be
+ *          blocked as with a normal mutex.
+ * @sa      posMutexCreate, posMutexLock, posMutexUnlock
+ */
+POSEXTERN POSMUTEX_t POSCALL posMutexCreateCeiling(VAR_t priority);
+#endif
+
 #if (DOX!=0) || (POSCFG_FEATURE_MUTEXDESTROY != 0)
 /**
  * Mutex function.
@@ -2161,7 +2681,10 @@ POSEXTERN VAR_t POSCALL posMutexTryLock(POSMUTEX_t mutex);
  * @param   mutex  handle to the mutex object.
  * @return  zero on success.
  * @note    ::POSCFG_FEATURE_MUTEXES must be defined to 1 
- *          to have mutex support compiled in.
+ *          to have mutex support compiled in.@n
+ *          When ::POSCFG_MUTEX_PRIO_INHERIT is set to 1, the task
+ *          holding the mutex inherits the priority of the blocked
+ *          caller until it releases the mutex.
  * @sa      posMutexTryLock, posMutexUnlock, posMutexCreate
  */
 POSEXTERN VAR_t POSCALL posMutexLock(POSMUTEX_t mutex);
@@ -2173,7 +2696,10 @@ POSEXTERN VAR_t POSCALL posMutexLock(POSMUTEX_t mutex);
  * @param   mutex  handle to the mutex object.
  * @return  zero on success.
  * @note    ::POSCFG_FEATURE_MUTEXES must be defined to 1 
- *          to have mutex support compiled in.
+ *          to have mutex support compiled in.@n
+ *          When ::POSCFG_MUTEX_PRIO_INHERIT is set to 1, the
+ *          priority the task had before it was boosted is restored
+ *          here (as far as no other held mutex still requires it).
  * @sa      posMutexLock, posMutexTryLock, posMutexCreate
  */
 POSEXTERN VAR_t POSCALL posMutexUnlock(POSMUTEX_t mutex);
@@ -2183,6 +2709,192 @@ POSEXTERN VAR_t POSCALL posMutexUnlock(POSMUTEX_t mutex);
 
 /*-------------------------------------------------------------------------*/
 
+#if (DOX!=0) || (POSCFG_FEATURE_CONDVARS != 0)
+/** @defgroup cond Condition Variable Functions
+ * @ingroup userapip
+ * A condition variable lets tasks wait until a condition on data
+ * protected by a mutex becomes true. A task locks the mutex, tests the
+ * condition and calls ::posCondWait while it is false. The function
+ * releases the mutex and blocks in one step, and locks the mutex again
+ * before it returns. A task that changes the data calls ::posCondSignal
+ * to wake one waiting task, or ::posCondBroadcast to wake all of them
+ * with a single scheduling decision. Since a woken task has to compete
+ * for the mutex, it must test the condition again.
+ * @{
+ */
+
+/**
+ * Condition variable function.
+ * Allocates a new condition variable object.
+ * @return  handle to the new condition variable. NULL is returned
+ *          on error.
+ * @note    ::POSCFG_FEATURE_CONDVARS must be defined to 1 
+ *          to have condition variable support compiled in.
+ * @sa      posCondDestroy, posCondWait, posCondSignal, posCondBroadcast
+ */
+POSEXTERN POSCOND_t POSCALL posCondCreate(void);
+
+/**
+ * Condition variable function.
+ * Frees a no more needed condition variable object.
+ * No task must wait on the object.
+ * @param   cond  handle to the condition variable.
+ * @note    ::POSCFG_FEATURE_CONDVARS must be defined to 1 
+ *          to have condition variable support compiled in.
+ * @sa      posCondCreate
+ */
+POSEXTERN void POSCALL posCondDestroy(POSCOND_t cond);
+
+/**
+ * Condition variable function.
+ * Releases the mutex and waits until the condition variable is
+ * signaled or the timeout has been reached. The mutex is locked
+ * again before the function returns, also on timeout.
+ * @param   cond   handle to the condition variable.
+ * @param   mutex  handle to the mutex. The caller must hold the
+ *                 mutex exactly once (not nested).
+ * @param   timeoutticks  timeout in timer ticks
+ *          (see ::HZ define and ::MS macro).
+ *          If this parameter is set to zero, the function immediately
+ *          returns. If this parameter is set to INFINITE, the
+ *          function will never time out.
+ * @return  zero when the task was woken by ::posCondSignal or
+ *          ::posCondBroadcast, 1 when the timeout was reached.
+ *          A negative value is returned on error, e.g. when the
+ *          caller does not hold the mutex.
+ * @note    ::POSCFG_FEATURE_CONDVARS must be defined to 1 
+ *          to have condition variable support compiled in.
+ * @sa      posCondSignal, posCondBroadcast, posMutexLock, HZ, MS
+ */
+POSEXTERN VAR_t POSCALL posCondWait(POSCOND_t cond, POSMUTEX_t mutex,
+                                    UINT_t timeoutticks);
+
+/**
+ * Condition variable function.
+ * Wakes the highest priority task that waits on the condition
+ * variable. Nothing happens when no task is waiting.
+ * @param   cond  handle to the condition variable.
+ * @return  zero on success.
+ * @note    ::POSCFG_FEATURE_CONDVARS must be defined to 1 
+ *          to have condition variable support compiled in.
+ * @sa      posCondBroadcast, posCondWait
+ */
+POSEXTERN VAR_t POSCALL posCondSignal(POSCOND_t cond);
+
+/**
+ * Condition variable function.
+ * Wakes all tasks that wait on the condition variable. The tasks are
+ * made ready together and the scheduler runs only once, so waking
+ * many tasks costs no more task switches than waking one.
+ * @param   cond  handle to the condition variable.
+ * @return  zero on success.
+ * @note    ::POSCFG_FEATURE_CONDVARS must be defined to 1 
+ *          to have condition variable support compiled in.
+ * @sa      posCondSignal, posCondWait
+ */
+POSEXTERN VAR_t POSCALL posCondBroadcast(POSCOND_t cond);
+
+#endif /* POSCFG_FEATURE_CONDVARS */
+/** @} */
+
+/*-------------------------------------------------------------------------*/
+
+#if (DOX!=0) || (POSCFG_FEATURE_RWLOCKS != 0)
+/** @defgroup rwlock Reader/Writer Lock Functions
+ * @ingroup userapip
+ * A reader/writer lock protects data that is read often and written
+ * rarely. Any number of tasks can hold the lock for reading at the
+ * same time, but a task that holds it for writing has exclusive access.
+ * The lock prefers writers: when a writer waits, new readers are
+ * blocked until the writer got and released the lock, so writers
+ * can not starve. When the last writer releases the lock, all waiting
+ * readers are made ready together with a single scheduling decision.
+ * The lock does not know its owners, it must not be nested for
+ * writing, and it does not boost the priority of a holding task.
+ * @{
+ */
+
+/**
+ * Reader/writer lock function.
+ * Allocates a new reader/writer lock object.
+ * @return  handle to the new lock. NULL is returned on error.
+ * @note    ::POSCFG_FEATURE_RWLOCKS must be defined to 1 
+ *          to have reader/writer lock support compiled in.
+ * @note    A reader/writer lock uses two event structures
+ *          (see ::POSCFG_MAX_EVENTS).
+ * @sa      posRwLockDestroy, posRwLockReadLock, posRwLockWriteLock
+ */
+POSEXTERN POSRWLOCK_t POSCALL posRwLockCreate(void);
+
+/**
+ * Reader/writer lock function.
+ * Frees a no more needed reader/writer lock object.
+ * The lock must not be held and no task must wait on it.
+ * @param   rwlock  handle to the reader/writer lock.
+ * @note    ::POSCFG_FEATURE_RWLOCKS must be defined to 1 
+ *          to have reader/writer lock support compiled in.
+ * @sa      posRwLockCreate
+ */
+POSEXTERN void POSCALL posRwLockDestroy(POSRWLOCK_t rwlock);
+
+/**
+ * Reader/writer lock function.
+ * Locks the object for reading. When the lock is held for writing or
+ * a writer waits for it, the task is blocked. Otherwise only the
+ * count of readers is incremented.
+ * @param   rwlock  handle to the reader/writer lock.
+ * @return  zero on success.
+ * @note    ::POSCFG_FEATURE_RWLOCKS must be defined to 1 
+ *          to have reader/writer lock support compiled in.
+ * @sa      posRwLockReadUnlock, posRwLockWriteLock
+ */
+POSEXTERN VAR_t POSCALL posRwLockReadLock(POSRWLOCK_t rwlock);
+
+/**
+ * Reader/writer lock function.
+ * Releases a lock that was taken with ::posRwLockReadLock.
+ * When the last reader leaves, the lock is handed over to the
+ * highest priority waiting writer.
+ * @param   rwlock  handle to the reader/writer lock.
+ * @return  zero on success. A negative value is returned on error,
+ *          e.g. when the lock is not held for reading.
+ * @note    ::POSCFG_FEATURE_RWLOCKS must be defined to 1 
+ *          to have reader/writer lock support compiled in.
+ * @sa      posRwLockReadLock
+ */
+POSEXTERN VAR_t POSCALL posRwLockReadUnlock(POSRWLOCK_t rwlock);
+
+/**
+ * Reader/writer lock function.
+ * Locks the object for writing. The task is blocked until no other
+ * task holds the lock.
+ * @param   rwlock  handle to the reader/writer lock.
+ * @return  zero on success.
+ * @note    ::POSCFG_FEATURE_RWLOCKS must be defined to 1 
+ *          to have reader/writer lock support compiled in.
+ * @sa      posRwLockWriteUnlock, posRwLockReadLock
+ */
+POSEXTERN VAR_t POSCALL posRwLockWriteLock(POSRWLOCK_t rwlock);
+
+/**
+ * Reader/writer lock function.
+ * Releases a lock that was taken with ::posRwLockWriteLock.
+ * The lock is handed over to the highest priority waiting writer.
+ * If no writer waits, all waiting readers are made ready at once.
+ * @param   rwlock  handle to the reader/writer lock.
+ * @return  zero on success. A negative value is returned on error,
+ *          e.g. when the lock is not held for writing.
+ * @note    ::POSCFG_FEATURE_RWLOCKS must be defined to 1 
+ *          to have reader/writer lock support compiled in.
+ * @sa      posRwLockWriteLock
+ */
+POSEXTERN VAR_t POSCALL posRwLockWriteUnlock(POSRWLOCK_t rwlock);
+
+#endif /* POSCFG_FEATURE_RWLOCKS */
+/** @} */
+
+/*-------------------------------------------------------------------------*/
+
 #if (DOX!=0) || (POSCFG_FEATURE_MSGBOXES != 0)
 /** @defgroup msg Message Box Functions
  * @ingroup userapip
@@ -2222,6 +2934,25 @@ POSEXTERN VAR_t POSCALL posMutexUnlock(POSMUTEX_t mutex);
  */
 POSEXTERN void* POSCALL posMessageAlloc(void);
 
+/**
+ * Message box function.
+ * Allocates a new message buffer that can hold at least the
+ * requested count of bytes. The buffer is taken from the smallest
+ * size class that is large enough (see ::POSCFG_MSG_SIZECLASSES).
+ * When all buffers of this class are in use, the task blocks until
+ * a buffer of the class is freed again. The buffer is sent and freed
+ * like buffers from ::posMessageAlloc.
+ * @param   size  count of bytes needed in the buffer.
+ * @return  the pointer to the new buffer. NULL is returned on error
+ *          or when the size is larger than the largest size class.
+ * @note    ::POSCFG_FEATURE_MSGBOXES must be defined to 1 
+ *          to have message box support compiled in.@n
+ *          ::POSCFG_MSG_MEMORY must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageAlloc, posMessageSend, posMessageFree
+ */
+POSEXTERN void* POSCALL posMessageAllocSize(UINT_t size);
+
 /**
  * Message box function.
  * Frees a message buffer again.
@@ -2321,6 +3052,148 @@ POSEXTERN VAR_t POSCALL posMessageAvailable(void);
 POSEXTERN void* POSCALL posMessageWait(UINT_t timeoutticks);
 #endif
 
+#if (DOX!=0) || (POSCFG_FEATURE_MSGBOXLIMIT != 0)
+/**
+ * Message box function.
+ * Sends a message to a task. When the message box of the receiving
+ * task is full (see ::posMessageBoxLimit), the sending task blocks
+ * until the receiver has taken a message out of the box or the
+ * timeout has been reached. Only the tasks that send to a full
+ * message box are blocked.
+ * @param   buf  pointer to the message to send
+ *               (see ::posMessageSend).
+ * @param   taskhandle  handle to the task to send the message to.
+ * @param   timeoutticks  timeout in timer ticks
+ *          (see ::HZ define and ::MS macro).
+ *          If this parameter is set to zero, the function immediately
+ *          returns. If this parameter is set to INFINITE, the
+ *          function will never time out.
+ * @return  zero on success. 1 is returned when the message box was
+ *          still full when the timeout was reached. In this case the
+ *          message buffer still belongs to the caller. When an error
+ *          condition exist, a negative value is returned and the
+ *          message buffer is freed.
+ * @note    ::POSCFG_FEATURE_MSGBOXES must be defined to 1 
+ *          to have message box support compiled in.@n
+ *          ::POSCFG_FEATURE_MSGBOXLIMIT must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageSend, posMessageBoxLimit, HZ, MS
+ */
+POSEXTERN VAR_t POSCALL posMessageSendWait(void *buf, POSTASK_t taskhandle,
+                                           UINT_t timeoutticks);
+
+/**
+ * Message box function.
+ * Sets the maximum count of messages that can be pending in the
+ * message box of the current task. When the box is full,
+ * ::posMessageSend fails with -E_NOMORE and ::posMessageSendWait
+ * blocks the sending task.
+ * @param   limit  maximum count of messages in the message box.
+ *                 Zero removes the limit.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::POSCFG_FEATURE_MSGBOXES must be defined to 1 
+ *          to have message box support compiled in.@n
+ *          ::POSCFG_FEATURE_MSGBOXLIMIT must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageSendWait, posMessageHighWater
+ */
+POSEXTERN VAR_t POSCALL posMessageBoxLimit(UINT_t limit);
+
+/**
+ * Message box function.
+ * Returns the highest count of messages that were pending in the
+ * message box of a task at the same time. This value helps to find
+ * the right message box limit and count of message buffers.
+ * @param   taskhandle  handle to the task.
+ * @return  highest count of pending messages.
+ * @note    ::POSCFG_FEATURE_MSGBOXES must be defined to 1 
+ *          to have message box support compiled in.@n
+ *          ::POSCFG_FEATURE_MSGBOXLIMIT must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageBoxLimit
+ */
+POSEXTERN UINT_t POSCALL posMessageHighWater(POSTASK_t taskhandle);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_MSGBATCH != 0)
+/**
+ * Message box function.
+ * Sends a batch of messages to a task. The messages are appended to
+ * the message box in one step, and the receiving task is woken only
+ * once. The messages are received in the order of the array.
+ * @param   bufs   array of pointers to the messages to send. The
+ *                 buffers must have been allocated with
+ *                 ::posMessageAlloc or ::posMessageAllocSize.
+ * @param   count  count of messages in the array.
+ * @param   taskhandle  handle to the task to send the messages to.
+ * @return  zero on success. When an error condition exist, a
+ *          negative value is returned and all message buffers
+ *          are freed. If the message box has a limit, either all or
+ *          none of the messages are sent.
+ * @note    ::POSCFG_FEATURE_MSGBOXES must be defined to 1 
+ *          to have message box support compiled in.@n
+ *          ::POSCFG_FEATURE_MSGBATCH must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageSend, posMessageGetAll, posMessageWaitAll
+ */
+POSEXTERN VAR_t POSCALL posMessageSendBatch(void **bufs, UINT_t count,
+                                            POSTASK_t taskhandle);
+
+/**
+ * Message box function.
+ * Takes all messages out of the message box at once. If no message
+ * is available, the task blocks until a new message is received.
+ * The messages are returned as a chain, use ::posMessageNext to walk
+ * through it. Each message must be freed with ::posMessageFree.
+ * @return  pointer to the first message of the chain.
+ *          NULL may be returned when the system has not
+ *          enough events.
+ * @note    ::POSCFG_FEATURE_MSGBOXES must be defined to 1 
+ *          to have message box support compiled in.@n
+ *          ::POSCFG_FEATURE_MSGBATCH must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageWaitAll, posMessageNext, posMessageSendBatch
+ */
+POSEXTERN void* POSCALL posMessageGetAll(void);
+
+/**
+ * Message box function.
+ * Takes all messages out of the message box at once. If no message
+ * is available, the task blocks until a new message is received or
+ * the timeout has been reached.
+ * @param   timeoutticks  timeout in timer ticks
+ *          (see ::HZ define and ::MS macro).
+ *          If this parameter is set to zero, the function immediately
+ *          returns. If this parameter is set to INFINITE, the
+ *          function will never time out.
+ * @return  pointer to the first message of the chain (see
+ *          ::posMessageGetAll). NULL is returned when no message
+ *          was received within the specified time.
+ * @note    ::POSCFG_FEATURE_MSGBOXES must be defined to 1 
+ *          to have message box support compiled in.@n
+ *          ::POSCFG_FEATURE_MSGBATCH must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageGetAll, posMessageNext, HZ, MS
+ */
+POSEXTERN void* POSCALL posMessageWaitAll(UINT_t timeoutticks);
+
+/**
+ * Message box function.
+ * Returns the next message of a chain that was received with
+ * ::posMessageGetAll or ::posMessageWaitAll. Call this function
+ * before the message is freed.
+ * @param   buf  pointer to a message of the chain.
+ * @return  pointer to the next message, or NULL at the end of
+ *          the chain.
+ * @note    ::POSCFG_FEATURE_MSGBOXES must be defined to 1 
+ *          to have message box support compiled in.@n
+ *          ::POSCFG_FEATURE_MSGBATCH must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageGetAll, posMessageWaitAll
+ */
+POSEXTERN void* POSCALL posMessageNext(void *buf);
+#endif
+
 #endif  /* POSCFG_FEATURE_MSGBOXES */
 /** @} */
 
@@ -2416,6 +3289,49 @@ POSEXTERN VAR_t POSCALL posFlagGet(POSFLAG_t flg, UVAR_t mode);
 POSEXTERN VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks);
 #endif
 
+#if (DOX!=0) || (POSCFG_FEATURE_FLAGWAITMASK != 0)
+/**
+ * Flag function.
+ * Waits until a combination of flags is set in the flag object or a
+ * timeout has happened. With ::POSFLAG_WAIT_ANY the task waits for one
+ * of the flags in the mask, with ::POSFLAG_WAIT_ALL for all of them.
+ * ::posFlagSet wakes only the tasks whose condition is met, so
+ * unrelated flags cause no task switches. When ::POSFLAG_WAIT_CLEAR
+ * is added to the mode, the flags of the mask are cleared when the
+ * condition is met. Higher priority tasks are served first, so a
+ * clearing task can take the flags away from lower priority waiters.
+ * @param   flg   handle to the flag object.
+ * @param   mask  bit mask of the flags to wait for. Flag number n is
+ *                bit n of the mask, so flags 0 .. ::MVAR_BITS - 2
+ *                can be used.
+ * @param   mode  ::POSFLAG_WAIT_ANY or ::POSFLAG_WAIT_ALL, optionally
+ *                ORed with ::POSFLAG_WAIT_CLEAR.
+ * @param   timeoutticks  timeout in timer ticks
+ *          (see ::HZ define and ::MS macro).
+ *          If this parameter is set to zero, the function immediately
+ *          returns. If this parameter is set to INFINITE, the
+ *          function will never time out.
+ * @return  the flags of the mask that were set when the condition was
+ *          met (positive value). If zero is returned, the timeout was
+ *          reached. A negative value denotes an error.
+ * @note    ::POSCFG_FEATURE_FLAGS must be defined to 1 
+ *          to have flag support compiled in.@n
+ *          ::POSCFG_FEATURE_FLAGWAITMASK must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posFlagCreate, posFlagSet, posFlagWait, HZ, MS
+ */
+POSEXTERN VAR_t POSCALL posFlagWaitMask(POSFLAG_t flg, UVAR_t mask,
+                                        UVAR_t mode, UINT_t timeoutticks);
+
+/** Wait for any flag of the mask (see ::posFlagWaitMask). */
+#define POSFLAG_WAIT_ANY         0
+/** Wait for all flags of the mask (see ::posFlagWaitMask). */
+#define POSFLAG_WAIT_ALL         1
+/** Clear the flags of the mask when the wait ends
+ *  (see ::posFlagWaitMask). */
+#define POSFLAG_WAIT_CLEAR       2
+#endif
+
 #define POSFLAG_MODE_GETSINGLE   0
 #define POSFLAG_MODE_GETMASK     1
 
@@ -2424,6 +3340,64 @@ POSEXTERN VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks);
 
 /*-------------------------------------------------------------------------*/
 
+#if (DOX!=0) || (POSCFG_FEATURE_EVENTWAITANY != 0)
+/** @defgroup waitany Waiting for Multiple Events
+ * @ingroup userapip
+ * With ::posEventWaitAny a task waits for several semaphores,
+ * flag objects and its own message box at the same time, without
+ * helper tasks that relay the events. The task is put into the wait
+ * lists of all objects. When the first one fires, it is taken out
+ * of the other lists before any other event can reach it.
+ * @{
+ */
+
+/** @brief  Object to wait for with ::posEventWaitAny.
+ * @sa posEventWaitAny, POSWAIT_SEMA, POSWAIT_FLAG, POSWAIT_MSGBOX
+ */
+typedef struct POSWAITOBJ {
+  UVAR_t  type;    /*!< type of the object, e.g. ::POSWAIT_SEMA */
+  void    *handle; /*!< semaphore or flag handle, NULL for a message box */
+} POSWAITOBJ_t;
+
+/** The object is a semaphore (::POSSEMA_t). */
+#define POSWAIT_SEMA     0
+/** The object is a flag object (::POSFLAG_t). */
+#define POSWAIT_FLAG     1
+/** The object is the message box of the calling task. */
+#define POSWAIT_MSGBOX   2
+
+/**
+ * Event function.
+ * Waits until one of several objects is ready or a timeout has been
+ * reached. A semaphore is ready when it can be taken, a flag object
+ * when one of its flags is set, and the message box when a message
+ * is available. When more objects are ready, the first one in the
+ * array is chosen.
+ * The semaphore count is taken by this function. Flags and messages
+ * stay in their objects, the task reads them with ::posFlagGet or
+ * ::posMessageGet afterwards.
+ * @param   objs   array of objects to wait for.
+ * @param   count  number of objects in the array.
+ * @param   timeoutticks  timeout in timer ticks
+ *          (see ::HZ define and ::MS macro).
+ *          If this parameter is set to zero, the function immediately
+ *          returns. If this parameter is set to INFINITE, the
+ *          function will never time out.
+ * @return  the index of the ready object in the array. When the
+ *          timeout was reached, the value of count is returned.
+ *          A negative value is returned on error.
+ * @note    ::POSCFG_FEATURE_EVENTWAITANY must be defined to 1 
+ *          to have this function compiled in.
+ * @sa      posSemaWait, posFlagWait, posMessageWait, HZ, MS
+ */
+POSEXTERN VAR_t POSCALL posEventWaitAny(const POSWAITOBJ_t *objs,
+                                        UVAR_t count, UINT_t timeoutticks);
+
+#endif  /* POSCFG_FEATURE_EVENTWAITANY */
+/** @} */
+
+/*-------------------------------------------------------------------------*/
+
 /** @defgroup timer Timer Functions
  * @ingroup userapip
  * A timer object is a counting variable that is counted down by the
@@ -2432,7 +3406,12 @@ POSEXTERN VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks);
  * Instead of using semaphore, timer can also invoke a callback function
  * (this is optional and controlled by ::POSCFG_FEATURE_TIMERCALLBACK).
  * If using callback, the function must be as quick and short as possible,
- * because it is invoked from timer interrupt context.
+ * because it is invoked from timer interrupt context. Alternatively the
+ * callbacks can be run by a timer daemon task
+ * (see ::POSCFG_FEATURE_TIMERDAEMON and ::posTimerDaemon).
+ * Timers set with ::posTimerSetNs are not counted by the tick, they
+ * fire from the high resolution compare interrupt of the port
+ * (see ::POSCFG_FEATURE_HIRESTIMER).
  * If the timer is in auto reload mode, the timer is restarted and
  * will signal the semaphore again and again, depending on the
  * period rate the timer is set to.
@@ -2504,6 +3483,8 @@ POSEXTERN POSTIMER_t POSCALL posTimerCreate(void);
  * @param   sema seaphore object that shall be signaled when timer fires.
  * @param   waitticks  number of initial wait ticks. The timer fires the
  *                     first time when this ticks has been expired.
+ *                     Zero is rejected if ::POSCFG_ARGCHECK is 2 or
+ *                     more, else the timer fires with the next tick.
  * @param   periodticks  After the timer has fired, it is reloaded with
  *                       this value, and will fire again when this count
  *                       of ticks has been expired (auto reload mode).
@@ -2527,6 +3508,8 @@ POSEXTERN VAR_t POSCALL posTimerSet(POSTIMER_t tmr, POSSEMA_t sema,
  * @param   arg        argument to callback function.
  * @param   waitticks  number of initial wait ticks. The timer fires the
  *                     first time when this ticks has been expired.
+ *                     Zero is rejected if ::POSCFG_ARGCHECK is 2 or
+ *                     more, else the timer fires with the next tick.
  * @param   periodticks  After the timer has fired, it is reloaded with
  *                       this value, and will fire again when this count
  *                       of ticks has been expired (auto reload mode).
@@ -2542,6 +3525,74 @@ POSEXTERN VAR_t POSCALL posTimerCallbackSet(POSTIMER_t tmr,
                                             UINT_t waitticks, UINT_t periodticks);
 #endif
 
+#if (DOX!=0) || (POSCFG_FEATURE_HIRESTIMER != 0)
+/**
+ * Timer function.
+ * Sets up a high resolution timer object. Same as ::posTimerSet,
+ * but the times are given in nanoseconds. The timer is not counted
+ * by the timer tick, it fires from the high resolution compare
+ * interrupt of the port. A periodic timer keeps its phase: each
+ * period is added to the last deadline, not to the time the
+ * interrupt was served.
+ * @param   tmr  handle to the timer object.
+ * @param   sema seaphore object that shall be signaled when timer fires.
+ * @param   waitns    initial wait time in nanoseconds, must not be zero.
+ * @param   periodns  period in nanoseconds for auto reload mode,
+ *                    zero for one shot mode.
+ * @return  zero on success.
+ * @note    ::POSCFG_FEATURE_TIMER and ::POSCFG_FEATURE_HIRESTIMER
+ *          must be defined to 1 to have this function compiled in.
+ * @sa      posTimerSet, posTimerCallbackSetNs, posTimerStart
+ */
+POSEXTERN VAR_t POSCALL posTimerSetNs(POSTIMER_t tmr, POSSEMA_t sema,
+                                      NSEC_t waitns, NSEC_t periodns);
+
+#if (DOX!=0) || (POSCFG_FEATURE_TIMERCALLBACK != 0)
+/**
+ * Timer function.
+ * Sets up a high resolution timer object with callback function.
+ * Same as ::posTimerCallbackSet, but the times are given in
+ * nanoseconds (see ::posTimerSetNs).
+ * @param   tmr  handle to the timer object.
+ * @param   callback   function that shall be called when timer fires.
+ * @param   arg        argument to callback function.
+ * @param   waitns     initial wait time in nanoseconds, must not be zero.
+ * @param   periodns   period in nanoseconds for auto reload mode,
+ *                     zero for one shot mode.
+ * @return  zero on success.
+ * @note    ::POSCFG_FEATURE_TIMERCALLBACK and ::POSCFG_FEATURE_HIRESTIMER
+ *          must be defined to 1 to have this function compiled in.
+ * @sa      posTimerCallbackSet, posTimerSetNs, posTimerStart
+ */
+POSEXTERN VAR_t POSCALL posTimerCallbackSetNs(POSTIMER_t tmr,
+                                              POSTIMERFUNC_t callback, void* arg,
+                                              NSEC_t waitns, NSEC_t periodns);
+#endif
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_TIMERDAEMON != 0)
+/**
+ * Timer function.
+ * Task function of the timer daemon. Create a task with this function
+ * (see ::posTaskCreate) to run the callbacks of expired timers in task
+ * context, at the priority of this task. The timer interrupt then only
+ * appends an expired timer to the queue of the daemon, and the callbacks
+ * may block, allocate memory or send messages. When a periodic timer
+ * expires again before its callback ran, the callback runs only once.
+ * Timers set with ::posTimerSet still signal their semaphore directly,
+ * and until the daemon runs, all callbacks are invoked from the timer
+ * interrupt as without the daemon. ::posTimerStop cancels a callback
+ * that waits in the queue.
+ * @param   arg  unused, should be NULL.
+ * @note    ::POSCFG_FEATURE_TIMERDAEMON must be defined to 1
+ *          to have this function compiled in.@n
+ *          Only one timer daemon can be started. It needs one event,
+ *          see ::POSCFG_MAX_EVENTS.
+ * @sa      posTimerCallbackSet, posTaskCreate
+ */
+POSEXTERN void posTimerDaemon(void *arg);
+#endif
+
 /**
  * Timer function.
  * Starts a timer. The timer will fire first time when the
@@ -2683,6 +3734,77 @@ POSEXTERN VAR_t POSCALL posSoftIntSetHandler(UVAR_t intno,
 POSEXTERN VAR_t POSCALL posSoftIntDelHandler(UVAR_t intno);
 #endif
 
+#if (DOX!=0) || (POSCFG_SOFTINT_COALESCE != 0)
+/**
+ * Software Interrupt Function.
+ * Sets the parameter merge function of a software interrupt.
+ * When ::POSCFG_SOFTINT_COALESCE is set, a software interrupt that is
+ * raised again while it is still pending is executed only once. The
+ * merge function combines the parameters of the calls, without it
+ * the handler gets the parameter of the last call.
+ * The merge function is called by ::posSoftInt with all interrupts
+ * disabled, so it must be very short.
+ * @param   intno number of the interrupt. Must be in the
+ *          range of 0 to ::POSCFG_SOFTINTERRUPTS - 1.
+ * @param   merge pointer to the merge function, or NULL.
+ * @note    ::POSCFG_FEATURE_SOFTINTS must be defined to 1 
+ *          to have software interrupt support compiled in.@n
+ *          ::POSCFG_SOFTINT_COALESCE must be defined to 1
+ *          to have this function compiled in.
+ * @return  zero on success.
+ * @sa      posSoftInt, posSoftIntSetHandler
+ */
+POSEXTERN VAR_t POSCALL posSoftIntSetMerge(UVAR_t intno,
+                                           POSSINTMERGEFUNC_t merge);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_SOFTINTDEFER != 0)
+/**
+ * Software Interrupt Function.
+ * Defers a function call to software interrupt level. The function
+ * is executed like a software interrupt handler, but it needs no
+ * interrupt number and no handler set with ::posSoftIntSetHandler.
+ * This function can be called from interrupt level.
+ * @param   func  pointer to the function to call.
+ * @param   arg   argument that is passed to the function.
+ * @note    ::POSCFG_FEATURE_SOFTINTS must be defined to 1 
+ *          to have software interrupt support compiled in.@n
+ *          ::POSCFG_FEATURE_SOFTINTDEFER must be defined to 1
+ *          to have this function compiled in.
+ * @return  zero on success. -E_NOMORE is returned when the queue
+ *          (see ::POSCFG_SOFTINTDEFERLEN) is full.
+ * @sa      posSoftInt
+ */
+POSEXTERN VAR_t POSCALL posSoftIntDefer(POSDEFERFUNC_t func, void *arg);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_SOFTINTSTATS != 0)
+/**
+ * Software Interrupt Function.
+ * Returns the count of software interrupts and deferred calls that
+ * were lost because the queue was full.
+ * @note    ::POSCFG_FEATURE_SOFTINTS must be defined to 1 
+ *          to have software interrupt support compiled in.@n
+ *          ::POSCFG_FEATURE_SOFTINTSTATS must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posSoftIntHighWater, POSCFG_SOFTINTQUEUELEN
+ */
+POSEXTERN UINT_t POSCALL posSoftIntDropCount(void);
+
+/**
+ * Software Interrupt Function.
+ * Returns the highest count of software interrupts that were pending
+ * at the same time. Use it to find a good value for
+ * ::POSCFG_SOFTINTQUEUELEN.
+ * @note    ::POSCFG_FEATURE_SOFTINTS must be defined to 1 
+ *          to have software interrupt support compiled in.@n
+ *          ::POSCFG_FEATURE_SOFTINTSTATS must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posSoftIntDropCount
+ */
+POSEXTERN UINT_t POSCALL posSoftIntHighWater(void);
+#endif
+
 #endif  /* POSCFG_FEATURE_SOFTINTS */
 /** @} */
 
@@ -3034,6 +4156,111 @@ POSEXTERN void POSCALL posListTerm(POSLISTHEAD_t *listhead);
 #endif /* POSCFG_FEATURE_LISTS */
 /** @} */
 
+/*-------------------------------------------------------------------------*/
+
+#if (DOX!=0) || (POSCFG_FEATURE_RINGBUF != 0)
+/** @defgroup ring Ring Buffers
+ * @ingroup userapip
+ * A ring buffer passes fixed size elements from exactly one producer
+ * to exactly one consumer, for example samples from an interrupt
+ * service routine to a task. ::posRingPut and the fast path of
+ * ::posRingGet only update the read and write indices, they neither
+ * lock the scheduler nor touch a semaphore. The consumer blocks on an
+ * internal semaphore only when the ring is empty, and only the first
+ * element put into the empty ring wakes it up again. So a burst of
+ * elements costs a single wakeup. @n
+ * Each ring buffer uses one event of ::POSCFG_MAX_EVENTS.
+ * @{
+ */
+
+/**
+ * Ring Buffer Function.
+ * Initializes a ring buffer.
+ * @param   ring      pointer to the ring buffer variable.
+ * @param   buffer    memory for the elements, it must be at least
+ *                    elemsize * count bytes large.
+ * @param   elemsize  size of an element in bytes.
+ * @param   count     count of elements the ring can hold. This must
+ *                    be a power of two and not larger than half the
+ *                    range of ::UVAR_t.
+ * @return  zero on success. -E_ARG is returned when count is not
+ *          a power of two, -E_NOMORE when no semaphore is available.
+ * @note    ::POSCFG_FEATURE_RINGBUF must be defined to 1 
+ *          to have ring buffer support compiled in.
+ * @sa      posRingDestroy, posRingPut, posRingGet, posRingWait
+ */
+POSEXTERN VAR_t POSCALL posRingCreate(POSRING_t *ring, void *buffer,
+                                      UINT_t elemsize, UINT_t count);
+
+/**
+ * Ring Buffer Function.
+ * Frees the semaphore of a ring buffer. The ring must not be used
+ * any more after this function was called.
+ * @param   ring      pointer to the ring buffer variable.
+ * @note    ::POSCFG_FEATURE_RINGBUF must be defined to 1 
+ *          to have ring buffer support compiled in.
+ * @sa      posRingCreate
+ */
+POSEXTERN void POSCALL posRingDestroy(POSRING_t *ring);
+
+/**
+ * Ring Buffer Function.
+ * Copies an element into the ring buffer. Only one task or interrupt
+ * service routine may put elements into a ring.
+ * @param   ring      pointer to the ring buffer variable.
+ * @param   elem      pointer to the element to copy.
+ * @return  zero on success. -E_NOMORE is returned when the ring
+ *          is full.
+ * @note    ::POSCFG_FEATURE_RINGBUF must be defined to 1 
+ *          to have ring buffer support compiled in. @n
+ *          This function can be called from interrupt level.
+ * @sa      posRingGet, posRingWait
+ */
+POSEXTERN VAR_t POSCALL posRingPut(POSRING_t *ring, const void *elem);
+
+/**
+ * Ring Buffer Function.
+ * Takes the oldest element out of the ring buffer. If the ring is
+ * empty, the task blocks until an element is available. Only one
+ * task may take elements out of a ring.
+ * @param   ring      pointer to the ring buffer variable.
+ * @param   elem      pointer to the memory the element is copied to.
+ * @return  zero on success.
+ * @note    ::POSCFG_FEATURE_RINGBUF must be defined to 1 
+ *          to have ring buffer support compiled in.
+ * @sa      posRingWait, posRingPut
+ */
+POSEXTERN VAR_t POSCALL posRingGet(POSRING_t *ring, void *elem);
+
+/**
+ * Ring Buffer Function.
+ * Takes the oldest element out of the ring buffer. If the ring is
+ * empty, the task blocks until an element is available or the
+ * timeout has been reached.
+ * @param   ring      pointer to the ring buffer variable.
+ * @param   elem      pointer to the memory the element is copied to.
+ * @param   timeoutticks  timeout in timer ticks
+ *          (see ::HZ define and ::MS macro).
+ *          If this parameter is set to zero, the function immediately
+ *          returns. If this parameter is set to INFINITE, the
+ *          function will never time out.
+ * @return  zero on success. 1 is returned when the ring was empty
+ *          and the timeout has been reached.
+ * @note    ::POSCFG_FEATURE_RINGBUF must be defined to 1 
+ *          to have ring buffer support compiled in. @n
+ *          ::POSCFG_FEATURE_SEMAWAIT must be defined to 1 to have
+ *          timeout support. Without it, every timeout other than
+ *          zero waits forever. @n
+ *          With a timeout of zero, this function can be called
+ *          from interrupt level.
+ * @sa      posRingGet, posRingPut, HZ, MS
+ */
+POSEXTERN VAR_t POSCALL posRingWait(POSRING_t *ring, void *elem,
+                                    UINT_t timeoutticks);
+
+#endif /* POSCFG_FEATURE_RINGBUF */
+/** @} */
+
 
 /*---------------------------------------------------------------------------
  *  DEBUG FEATURES
@@ -3121,8 +4348,22 @@ enum PTASKSTATE
   task_waitingForFlagWithTimeout = 10, /*!< 10: Task is waiting for a
                            flag event, with timeout. */
   task_waitingForMessage = 11, /*!< 11: Task is waiting for a message. */
-  task_waitingForMessageWithTimeout = 12   /*!< 12: Task is waiting for a
+  task_waitingForMessageWithTimeout = 12,  /*!< 12: Task is waiting for a
                            message, with timeout. */
+  task_waitingForCondvar = 13, /*!< 13: Task is waiting for a
+                           condition variable. */
+  task_waitingForCondvarWithTimeout = 14,  /*!< 14: Task is waiting for a
+                           condition variable, with timeout. */
+  task_waitingForRwLock = 15, /*!< 15: Task is waiting for a
+                           reader/writer lock. */
+  task_waitingForEvents = 16, /*!< 16: Task is waiting for one of
+                           several events. */
+  task_waitingForEventsWithTimeout = 17,  /*!< 17: Task is waiting for
+                           one of several events, with timeout. */
+  task_waitingForMsgSpace = 18, /*!< 18: Task is waiting for space in
+                           a message box. */
+  task_waitingForMsgSpaceWithTimeout = 19  /*!< 19: Task is waiting for
+                           space in a message box, with timeout. */
 };
 typedef enum PTASKSTATE PTASKSTATE;
 
@@ -3134,7 +4375,9 @@ enum PEVENTTYPE
 {
   event_semaphore = 0,  /*!< 0: The event object is a semaphore. */
   event_mutex     = 1,  /*!< 1: The event object is a mutex. */
-  event_flags     = 2   /*!< 2: The event object is a flags field. */
+  event_flags     = 2,  /*!< 2: The event object is a flags field. */
+  event_condvar   = 3,  /*!< 3: The event object is a condition variable. */
+  event_rwlock    = 4   /*!< 4: The event object is a reader/writer lock. */
 };
 typedef enum PEVENTTYPE PEVENTTYPE;
 
@@ -3201,7 +4444,10 @@ typedef struct PICOTASK
   struct PICOEVENT  *event; /*!< @brief
                                  Cross-reference to the involved event.*/
   UINT_t            timeout;/*!< @brief
-                                 State of the task's timeout counter. */
+                                 State of the task's timeout counter.
+                                 Note that the counter is relative to
+                                 the counter of the previous task in
+                                 the list of sleeping tasks. */
 } PICOTASK;
 
 #if DOX
@@ -3410,6 +4656,9 @@ struct POSTASK {
     UVAR_t      bit_y;
     UVAR_t      idx_y;
 #endif
+#if SYS_TASKTABSIZE_Z > 1
+    UVAR_t      bit_z;
+#endif
 #ifndef POS_DEBUGHELP
     UINT_t      ticks;
 #endif
@@ -3424,6 +4673,15 @@ struct POSTASK {
     POSSEMA_t   msgsem;
     void        *firstmsg;
     void        *lastmsg;
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+    POSSEMA_t   msgsendsem;
+#if POSCFG_FEATURE_EXIT != 0
+    UVAR_t      msgsendexit;
+#endif
+    UINT_t      msgcount;
+    UINT_t      msglimit;
+    UINT_t      msghwm;
+#endif
 #endif
 #ifdef POS_DEBUGHELP
     struct PICOTASK  deb;
@@ -3431,6 +4689,42 @@ struct POSTASK {
 #if SYS_TASKEVENTLINK != 0
     void        *event;
 #endif
+#if POSCFG_FEATURE_EVENTWAITANY != 0
+    const void  *waitany;
+    UVAR_t      waitanycnt;
+    UVAR_t      waitanyidx;
+#endif
+#if POSCFG_FEATURE_FLAGWAITMASK != 0
+    UVAR_t      flagmask;
+    UVAR_t      flagmode;
+#endif
+#if SYS_MUTEXBOOST != 0
+    void        *mutexes;
+    UVAR_t      base_bit_x;
+#if SYS_TASKTABSIZE_Y > 1
+    UVAR_t      base_idx_y;
+#endif
+#endif
+#if POSCFG_FEATURE_HIRESTIMER != 0
+    struct POSTASK  *hrnext;
+    NSEC_t      hrexpiry;
+#endif
+#if POSCFG_FEATURE_EDF != 0
+    JIF_t       edfrelease;
+    JIF_t       edfdeadline;
+    UINT_t      edfperiod;
+    UINT_t      edfreldl;
+    UVAR_t      edfidx;
+#endif
+#if POSCFG_FEATURE_BUDGET != 0
+    struct POSTASK  *bnext;
+    JIF_t       breplenish;
+    UINT_t      budget;
+    UINT_t      bperiod;
+    UINT_t      bleft;
+    UINT_t      overruns;
+    UVAR_t      throttled;
+#endif
 #endif /* !DOX */
 };
 
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2011-2013, Ari Suutari <ari@stonepile.fi>.
+ * All rights reserved. 
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT,  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Context switch for PORTCFG_FAST_CONTEXT.
+ *
+ * void portSwitchStack(void **oldsp, void *newsp);
+ *
+ * Pushes the callee saved registers to the current stack, stores the
+ * stack pointer to *oldsp, loads newsp and pops the registers of the
+ * next task. New tasks are prepared by p_pos_initTask so that the
+ * switch returns to portTaskEntry, with the task function in the
+ * first and its argument in the second saved register.
+ *
+ * This file is assembled on all hosts, the routines are only
+ * used if PORTCFG_FAST_CONTEXT is set.
+ */
+
+#if defined(__ELF__)
+#define FUNC(name) .globl name; .type name, %function; name:
+#define ENDFUNC(name) .size name, .-name
+#else
+#define FUNC(name) .globl name; name:
+#define ENDFUNC(name)
+#endif
+
+        .text
+
+#if defined(__x86_64__)
+
+/*
+ * Frame: r15 r14 r13 r12 rbx rbp, return address
+ */
+        .p2align 4
+FUNC(portSwitchStack)
+        pushq   %rbp
+        pushq   %rbx
+        pushq   %r12
+        pushq   %r13
+        pushq   %r14
+        pushq   %r15
+        movq    %rsp, (%rdi)
+        movq    %rsi, %rsp
+        popq    %r15
+        popq    %r14
+        popq    %r13
+        popq    %r12
+        popq    %rbx
+        popq    %rbp
+        ret
+ENDFUNC(portSwitchStack)
+
+        .p2align 4
+FUNC(portTaskEntry)
+        movq    %r12, %rdi
+        movq    %r13, %rsi
+        call    portTaskStart
+        ud2
+ENDFUNC(portTaskEntry)
+
+#elif defined(__aarch64__)
+
+/*
+ * Frame: x19-x28, x29 x30, d8-d15
+ */
+        .p2align 4
+FUNC(portSwitchStack)
+        sub     sp, sp, #160
+        stp     x19, x20, [sp, #0]
+        stp     x21, x22, [sp, #16]
+        stp     x23, x24, [sp, #32]
+        stp     x25, x26, [sp, #48]
+        stp     x27, x28, [sp, #64]
+        stp     x29, x30, [sp, #80]
+        stp     d8,  d9,  [sp, #96]
+        stp     d10, d11, [sp, #112]
+        stp     d12, d13, [sp, #128]
+        stp     d14, d15, [sp, #144]
+        mov     x9, sp
+        str     x9, [x0]
+        mov     sp, x1
+        ldp     x19, x20, [sp, #0]
+        ldp     x21, x22, [sp, #16]
+        ldp     x23, x24, [sp, #32]
+        ldp     x25, x26, [sp, #48]
+        ldp     x27, x28, [sp, #64]
+        ldp     x29, x30, [sp, #80]
+        ldp     d8,  d9,  [sp, #96]
+        ldp     d10, d11, [sp, #112]
+        ldp     d12, d13, [sp, #128]
+        ldp     d14, d15, [sp, #144]
+        add     sp, sp, #160
+        ret
+ENDFUNC(portSwitchStack)
+
+        .p2align 4
+FUNC(portTaskEntry)
+        mov     x0, x19
+        mov     x1, x20
+        bl      portTaskStart
+        brk     #0
+ENDFUNC(portTaskEntry)
+
+#endif
+
+#if defined(__ELF__)
+        .section .note.GNU-stack,"",%progbits
+#endif
@@ -36,9 +36,32 @@
 #include <assert.h>
 #include <signal.h>
 #include <sys/time.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <time.h>
 
-static void timerExpiredContext(void);
 static void timerExpired(int sig, siginfo_t *info, void *uap);
+static void timerSignal(void);
+static void timerInterrupt(void);
+
+void portTaskStart(POSTASKFUNC_t funcptr, void *funcarg);
+
+#if PORTCFG_FAST_CONTEXT
+
+void portSwitchStack(void **oldsp, void *newsp);
+void portTaskEntry(void);
+
+static void timerRun(void);
+
+/*
+ * Stack pointer of main(), saved when the first task is started.
+ */
+static void *mainStackPtr;
+
+#else
+
+static void timerExpiredContext(void);
+static void timerEnterContext(void);
 
 #if PORTCFG_IRQ_STACK_SIZE >= PORTCFG_MIN_STACK_SIZE
 static char sigStack[PORTCFG_IRQ_STACK_SIZE];
@@ -48,64 +71,277 @@ static char sigStack[PORTCFG_MIN_STACK_SIZE];
 
 ucontext_t sigContext;
 
+#endif
+
+#if PORTCFG_SOFT_IRQ_MASK
 /*
- * Initialize task context.
+ * User space interrupt mask. Interrupts are disabled
+ * until the first task is started.
  */
+volatile sig_atomic_t portIrqMasked = 1;
+volatile sig_atomic_t portIrqPending = 0;
+#endif
 
-#if (POSCFG_TASKSTACKTYPE == 1)
+/*
+ * Timer signals that were raised but not served yet.
+ */
+static volatile sig_atomic_t tickPending = 0;
 
-VAR_t p_pos_initTask(POSTASK_t task, 
-                    UINT_t stacksize,
-                    POSTASKFUNC_t funcptr, 
-                    void *funcarg)
+#if POSCFG_FEATURE_HIRESTIMER != 0
+/*
+ * POSIX timer for the high resolution compare. It raises a
+ * real-time signal of its own: standard signals do not queue,
+ * so sharing SIGALRM with the tick would lose one of them when
+ * both arrive while the signal is blocked.
+ */
+#define HIRES_SIGNAL  SIGRTMIN
+
+static void hiresExpired(int sig, siginfo_t *info, void *uap);
+
+static timer_t hiresTimer;
+static volatile sig_atomic_t hiresPending = 0;
+#endif
+
+#if POSCFG_FEATURE_TICKLESS != 0
+/*
+ * Length of a tick and state of tickless idle. While the
+ * periodic tick is suspended, tickBase is the time of the
+ * last tick that was counted.
+ */
+#define TICK_NS  (1000000000ULL / HZ)
+
+static volatile sig_atomic_t tickSuspended = 0;
+static unsigned long long tickBase;
+#endif
+
+/*
+ * All tasks start here, with interrupts enabled. When the
+ * task function returns, the task exits on its own stack.
+ */
+void portTaskStart(POSTASKFUNC_t funcptr, void *funcarg)
 {
-  int ret;
-  volatile int stk = stacksize;
+#if PORTCFG_SOFT_IRQ_MASK
+  portIrqMasked = 0;
+#endif
+  funcptr(funcarg);
+  posTaskExit();
+}
 
-  if (stk < PORTCFG_MIN_STACK_SIZE)
-    stk = PORTCFG_MIN_STACK_SIZE;
+/*
+ * Prepare the context of a new task, so that it starts in
+ * portTaskStart. The stack memory is from stack to stack + size.
+ */
+static void initContext(POSTASK_t task,
+                        unsigned char *stack,
+                        UINT_t size,
+                        POSTASKFUNC_t funcptr, 
+                        void *funcarg)
+{
+#if PORTCFG_FAST_CONTEXT
 
-  ret = getcontext(&task->ucontext);
-  assert(ret != -1);
+  void **sp;
 
-  ret = getcontext(&task->uexit);
-  assert(ret != -1);
+/*
+ * Build the frame popped by portSwitchStack. It returns
+ * to portTaskEntry, which calls portTaskStart.
+ */
+  sp = (void**) (((MPTR_t) (stack + size)) & ~(MPTR_t) 15);
 
-  task->uexit.uc_link           = 0;
-  task->uexit.uc_stack.ss_sp    = malloc(stk);
-  task->uexit.uc_stack.ss_size  = stk;
-  task->uexit.uc_stack.ss_flags = 0;
+#if defined(__x86_64__)
 
-  makecontext(&task->uexit, (void(*)(void)) posTaskExit, 0);
+  sp -= 9;
+  memset(sp, '\0', 9 * sizeof(void*));
+  sp[2] = funcarg;                      /* r13 */
+  sp[3] = (void*) funcptr;              /* r12 */
+  sp[6] = (void*) portTaskEntry;        /* return address */
 
-  task->stack = malloc(stk);
-  task->stackSize = stk;
+#elif defined(__aarch64__)
+
+  sp -= 20;
+  memset(sp, '\0', 20 * sizeof(void*));
+  sp[0]  = (void*) funcptr;             /* x19 */
+  sp[1]  = funcarg;                     /* x20 */
+  sp[11] = (void*) portTaskEntry;       /* x30 */
+
+#endif
+
+  task->stackptr = sp;
 
-  task->ucontext.uc_link           = &task->uexit;
-  task->ucontext.uc_stack.ss_sp    = (char*)task->stack;
-  task->ucontext.uc_stack.ss_size  = stk;
+#else
+
+  int ret;
+
+  ret = getcontext(&task->ucontext);
+  assert(ret != -1);
+
+  task->ucontext.uc_link           = 0;
+  task->ucontext.uc_stack.ss_sp    = (char*)stack;
+  task->ucontext.uc_stack.ss_size  = size;
   task->ucontext.uc_stack.ss_flags = 0;
   sigemptyset(&task->ucontext.uc_sigmask);
-  assert(task->ucontext.uc_stack.ss_sp != 0);
 
-#if POSCFG_ARGCHECK > 1
-  nosMemSet(task->stack, PORT_STACK_MAGIC, stk);
+  makecontext(&task->ucontext, (void(*)(void)) portTaskStart, 2, funcptr, funcarg);
+
 #endif
+}
+
+/*
+ * Initialize task context.
+ */
 
-  makecontext(&task->ucontext, (void(*)(void)) funcptr, 1, funcarg);
+#if (POSCFG_TASKSTACKTYPE == 0)
+
+/*
+ * The size of the stack memory is not known here. Only the
+ * top of the stack is used, so the minimum size is assumed.
+ */
+void p_pos_initTask(POSTASK_t task,
+                    void *stackstart,
+                    POSTASKFUNC_t funcptr,
+                    void *funcarg)
+{
+  initContext(task,
+              (unsigned char*)stackstart - PORTCFG_MIN_STACK_SIZE,
+              PORTCFG_MIN_STACK_SIZE,
+              funcptr,
+              funcarg);
+}
+
+#else
+
+/*
+ * Stack pool. Stacks are mapped with a PROT_NONE guard page
+ * below them, the stacks of exited tasks are kept for reuse.
+ * A free stack is linked through its lowest bytes.
+ */
+typedef struct PORTSTACK {
+  struct PORTSTACK *next;
+  UINT_t           size;
+} PORTSTACK_t;
 
+static PORTSTACK_t   *stackPool;
+static UINT_t        stackPoolCount;
+static size_t        pageSize;
+
+/*
+ * Stack of the last exited task. posTaskExit calls p_pos_freeStack
+ * while it still runs on this stack, so it is given to the pool
+ * when the next task is created or exits.
+ */
+static unsigned char *deadStack;
+static UINT_t        deadStackSize;
+
+static void stackFree(unsigned char *stack, UINT_t size)
+{
+  PORTSTACK_t *s;
+
+  if (stackPoolCount < PORTCFG_STACK_POOL)
+  {
+    s = (PORTSTACK_t*) stack;
+    s->size = size;
+    s->next = stackPool;
+    stackPool = s;
+    ++stackPoolCount;
+  }
+  else
+  {
+    munmap(stack - pageSize, size + pageSize);
+  }
+}
+
+static void stackFlushDead(void)
+{
+  if (deadStack != NULL)
+  {
+    stackFree(deadStack, deadStackSize);
+    deadStack = NULL;
+  }
+}
+
+static unsigned char *stackAlloc(UINT_t size)
+{
+  PORTSTACK_t **sp;
+  PORTSTACK_t *s;
+  unsigned char *mem;
+
+  stackFlushDead();
+  for (sp = &stackPool; *sp != NULL; sp = &(*sp)->next)
+  {
+    s = *sp;
+    if (s->size == size)
+    {
+      *sp = s->next;
+      --stackPoolCount;
+      return (unsigned char*) s;
+    }
+  }
+
+  mem = mmap(NULL, size + pageSize, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mem == MAP_FAILED)
+    return NULL;
+
+  if (mprotect(mem, pageSize, PROT_NONE) == -1)
+  {
+    munmap(mem, size + pageSize);
+    return NULL;
+  }
+
+  return mem + pageSize;
+}
+
+static VAR_t initTask(POSTASK_t task,
+                      UINT_t stacksize,
+                      POSTASKFUNC_t funcptr, 
+                      void *funcarg)
+{
+  UINT_t stk = stacksize;
+
+  if (pageSize == 0)
+    pageSize = sysconf(_SC_PAGESIZE);
+
+  if (stk < PORTCFG_MIN_STACK_SIZE)
+    stk = PORTCFG_MIN_STACK_SIZE;
+
+  stk = (stk + pageSize - 1) & ~(pageSize - 1);
+
+  task->stack = stackAlloc(stk);
+  if (task->stack == NULL)
+    return -1;
+
+  task->stackSize = stk;
+  initContext(task, task->stack, stk, funcptr, funcarg);
   return 0;
 }
 
+#if (POSCFG_TASKSTACKTYPE == 1)
 
-void  p_pos_freeStack(POSTASK_t task)
+VAR_t p_pos_initTask(POSTASK_t task, 
+                    UINT_t stacksize,
+                    POSTASKFUNC_t funcptr, 
+                    void *funcarg)
 {
-  free(task->ucontext.uc_stack.ss_sp);
-  free(task->uexit.uc_stack.ss_sp);
+  return initTask(task, stacksize, funcptr, funcarg);
 }
 
 #else
-#error "Error in configuration for the port (poscfg.h): POSCFG_TASKSTACKTYPE must be 1"
+
+VAR_t p_pos_initTask(POSTASK_t task, 
+                    POSTASKFUNC_t funcptr, 
+                    void *funcarg)
+{
+  return initTask(task, PORTCFG_MIN_STACK_SIZE, funcptr, funcarg);
+}
+
+#endif
+
+void  p_pos_freeStack(POSTASK_t task)
+{
+  stackFlushDead();
+  deadStack = task->stack;
+  deadStackSize = task->stackSize;
+}
+
 #endif
 
 /*
@@ -120,10 +356,47 @@ p_pos_initArch(void)
 
   p_pos_blockSigs(NULL);
 
+#if PORTCFG_FAST_CONTEXT == 0
+/*
+ * The interrupt context never returns, so it can be
+ * prepared once and entered again for each timer signal.
+ */
+  getcontext(&sigContext);
+  sigContext.uc_stack.ss_sp = sigStack;
+  sigContext.uc_stack.ss_size = sizeof(sigStack);
+  sigContext.uc_stack.ss_flags = 0;
+  sigContext.uc_link = 0;
+  sigfillset(&sigContext.uc_sigmask);
+
+  makecontext(&sigContext, timerExpiredContext, 0);
+#endif
+
   memset(&sig, '\0', sizeof(sig));
+  sigemptyset(&sig.sa_mask);
   sig.sa_sigaction = timerExpired;
   sig.sa_flags = SA_RESTART | SA_SIGINFO; /* SA_NODEFER ?? */
+#if PORTCFG_FAST_CONTEXT
+/*
+ * The interrupt may switch tasks inside the handler. The timer
+ * signal must stay unblocked for the next task, a nested signal
+ * is held off by portIrqMasked.
+ */
+  sig.sa_flags |= SA_NODEFER;
+#else
+/*
+ * Both timer signals enter the same interrupt context,
+ * each one is blocked while the other is served.
+ */
+  sigaddset(&sig.sa_mask, SIGALRM);
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  sigaddset(&sig.sa_mask, HIRES_SIGNAL);
+#endif
+#endif
   sigaction(SIGALRM, &sig, NULL);
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  sig.sa_sigaction = hiresExpired;
+  sigaction(HIRES_SIGNAL, &sig, NULL);
+#endif
   
   memset(&timer, '\0', sizeof(timer));
   timer.it_interval.tv_usec = (1000 * 1000) / HZ;
@@ -132,8 +405,117 @@ p_pos_initArch(void)
   timer.it_value.tv_sec = timer.it_interval.tv_sec;
   timer.it_value.tv_usec = timer.it_interval.tv_usec;
   setitimer(ITIMER_REAL, &timer, NULL);
+
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  {
+    struct sigevent sev;
+
+    memset(&sev, '\0', sizeof(sev));
+    sev.sigev_notify = SIGEV_SIGNAL;
+    sev.sigev_signo = HIRES_SIGNAL;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &hiresTimer) == -1)
+    {
+      perror("timer_create");
+      exit(1);
+    }
+  }
+#endif
+}
+
+#if (POSCFG_FEATURE_HIRESTIMER != 0) || (POSCFG_FEATURE_TICKLESS != 0)
+
+static unsigned long long monotonicNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long) ts.tv_sec * 1000000000 + ts.tv_nsec;
 }
 
+#endif
+
+#if POSCFG_FEATURE_HIRESTIMER != 0
+
+/*
+ * The free running counter is CLOCK_MONOTONIC.
+ */
+NSEC_t p_pos_hiresNow(void)
+{
+  return (NSEC_t) monotonicNs();
+}
+
+/*
+ * Arm the POSIX timer to the absolute deadline. A deadline
+ * in the past expires at once.
+ */
+void p_pos_hiresSetCompare(NSEC_t deadline)
+{
+  struct itimerspec its;
+
+  memset(&its, '\0', sizeof(its));
+  its.it_value.tv_sec = (time_t) (deadline / 1000000000);
+  its.it_value.tv_nsec = (long) (deadline % 1000000000);
+  if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+    its.it_value.tv_nsec = 1; /* zero would disarm the timer */
+
+  timer_settime(hiresTimer, TIMER_ABSTIME, &its, NULL);
+}
+
+#endif
+
+#if PORTCFG_FAST_CONTEXT
+
+/*
+ * Called by pico]OS to switch tasks when not serving interrupt.
+ * The interrupt mask flag stays set, the next task continues
+ * either here inside a locked section, or in timerRun, which
+ * clears the flag, or in portTaskStart.
+ */
+
+void p_pos_softContextSwitch(void)
+{
+  POSTASK_t old;
+
+  old = posCurrentTask_g;
+  posCurrentTask_g = posNextTask_g;
+
+  portSwitchStack(&old->stackptr, posCurrentTask_g->stackptr);
+}
+
+/*
+ * Called by pico]OS at end of interrupt handler to switch task.
+ * The interrupt runs on the stack of the interrupted task,
+ * so this returns when the task is switched back in. The
+ * signal handler then returns to the interrupted code.
+ */
+
+void p_pos_intContextSwitch(void)
+{
+  POSTASK_t old;
+
+  old = posCurrentTask_g;
+  posCurrentTask_g = posNextTask_g;
+
+  portSwitchStack(&old->stackptr, posCurrentTask_g->stackptr);
+}
+
+/*
+ * Called by pico]OS to start first task. Task
+ * must be prepared by p_pos_initTask before calling this.
+ */
+
+void p_pos_startFirstContext()
+{
+  sigset_t set;
+
+  sigemptyset(&set);
+  sigprocmask(SIG_SETMASK, &set, NULL);
+  portSwitchStack(&mainStackPtr, posCurrentTask_g->stackptr);
+  assert(0);
+}
+
+#else
+
 /*
  * Called by pico]OS to switch tasks when not serving interrupt.
  * Since we run tasks in system/user mode, "swi" instruction is
@@ -154,6 +536,11 @@ void p_pos_softContextSwitch(void)
   old = &posCurrentTask_g->ucontext;
   posCurrentTask_g = posNextTask_g;
 
+  /*
+   * With PORTCFG_SOFT_IRQ_MASK, the interrupt mask flag stays set.
+   * The task we return to is either suspended here too, inside a
+   * locked section, or in timerEnterContext, which clears the flag.
+   */
   ret = swapcontext(old, &posCurrentTask_g->ucontext);
   assert(ret != -1);
 }
@@ -193,6 +580,8 @@ void p_pos_startFirstContext()
   assert(ret != -1);
 }
 
+#endif
+
 void p_pos_blockSigs(sigset_t* old)
 {
   sigset_t set;
@@ -208,34 +597,274 @@ void p_pos_unblockSigs(sigset_t* old)
 
 void p_pos_idleTaskHook()
 {
+#if POSCFG_FEATURE_POWER == 0
   sigset_t set;
 
   sigemptyset(&set);
   sigsuspend(&set);
+#endif
+}
+
+#if POSCFG_FEATURE_POWER != 0
+
+/*
+ * Called by the idle task with the scheduler locked. Wait
+ * for the next signal. With PORTCFG_SOFT_IRQ_MASK, the handler
+ * only marks the interrupt pending, it is replayed when the
+ * idle task unlocks. Otherwise the interrupt runs here, and
+ * c_pos_intExit leaves scheduling to the idle task.
+ * With POSCFG_FEATURE_TICKLESS, the periodic tick is suspended
+ * during the wait if the next wakeup is more than a tick away.
+ */
+void p_pos_powerSleep()
+{
+  sigset_t set, old;
+#if POSCFG_FEATURE_TICKLESS != 0
+  UINT_t next;
+
+  next = c_pos_nextWakeup();
+  if (next != INFINITE && next > HZ * 3600)
+    next = HZ * 3600;
+  if (next > 1)
+    p_pos_powerTickSuspend((UVAR_t) next);
+#endif
+
+  sigfillset(&set);
+  sigprocmask(SIG_BLOCK, &set, &old);
+#if PORTCFG_SOFT_IRQ_MASK
+  if (!portIrqPending)
+#endif
+  {
+    sigemptyset(&set);
+    sigsuspend(&set);
+  }
+  sigprocmask(SIG_SETMASK, &old, NULL);
+
+#if POSCFG_FEATURE_TICKLESS != 0
+  if (tickSuspended)
+    p_pos_powerTickResume();
+#endif
+}
+
+#endif
+
+#if POSCFG_FEATURE_TICKLESS != 0
+
+static void nsToTimeval(unsigned long long ns, struct timeval *tv)
+{
+  tv->tv_sec = (time_t) (ns / 1000000000);
+  tv->tv_usec = (suseconds_t) ((ns % 1000000000) / 1000);
+  if (tv->tv_sec == 0 && tv->tv_usec == 0)
+    tv->tv_usec = 1; /* zero would disarm the timer */
+}
+
+/*
+ * Replace the periodic tick by a one-shot timer that expires
+ * with the given tick. The phase of the tick is kept.
+ */
+void p_pos_powerTickSuspend(UVAR_t ticks)
+{
+  struct itimerval timer, old;
+  unsigned long long now, left;
+  sigset_t pending;
+
+  memset(&timer, '\0', sizeof(timer));
+  setitimer(ITIMER_REAL, &timer, &old);
+  now = monotonicNs();
+
+  left = (unsigned long long) old.it_value.tv_sec * 1000000000 +
+         (unsigned long long) old.it_value.tv_usec * 1000;
+  if (left == 0 || left > TICK_NS)
+    left = TICK_NS;
+
+  tickBase = now + left - TICK_NS;
+
+/*
+ * A tick that arrived while interrupts were disabled is still
+ * pending, either marked by the handler or blocked in the kernel.
+ * It is not counted yet, so it is counted with the time slept.
+ */
+  sigpending(&pending);
+  if (tickPending || sigismember(&pending, SIGALRM))
+    tickBase -= TICK_NS;
+
+  tickSuspended = 1;
+
+  if ((UINT_t) ticks == INFINITE)
+    return;
+
+  nsToTimeval(left + (ticks - 1) * TICK_NS, &timer.it_value);
+  setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+/*
+ * Count the ticks that passed while sleeping and restart
+ * the periodic tick in phase.
+ */
+void p_pos_powerTickResume()
+{
+  struct itimerval timer;
+  unsigned long long elapsed;
+
+  elapsed = monotonicNs() - tickBase;
+
+  memset(&timer, '\0', sizeof(timer));
+  nsToTimeval(TICK_NS, &timer.it_interval);
+  nsToTimeval(TICK_NS - elapsed % TICK_NS, &timer.it_value);
+  setitimer(ITIMER_REAL, &timer, NULL);
+
+  tickPending = 0;
+  tickSuspended = 0;
+  if (elapsed >= TICK_NS)
+    c_pos_timerStep((UVAR_t) (elapsed / TICK_NS));
 }
 
+#endif
+
+/*
+ * Signal handlers of the timers. Each one notes its timer
+ * as pending and enters the interrupt.
+ */
+static void timerExpired(int sig, siginfo_t *info, void *ucontext)
+{
+  tickPending = 1;
+  timerSignal();
+}
+
+#if POSCFG_FEATURE_HIRESTIMER != 0
+static void hiresExpired(int sig, siginfo_t *info, void *ucontext)
+{
+  hiresPending = 1;
+  timerSignal();
+}
+#endif
+
+/*
+ * Serve the pending timers. A signal that arrives meanwhile
+ * sets the flag again and is served by the next run. The
+ * wakeup signal of tickless idle is not a tick, the time
+ * slept is counted by p_pos_powerTickResume.
+ */
+static void timerInterrupt()
+{
+  if (tickPending)
+  {
+    tickPending = 0;
+#if POSCFG_FEATURE_TICKLESS != 0
+    if (!tickSuspended)
+#endif
+      c_pos_timerInterrupt();
+  }
+
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  if (hiresPending)
+  {
+    hiresPending = 0;
+    c_pos_hiresInterrupt();
+  }
+#endif
+}
+
+#if PORTCFG_FAST_CONTEXT
+
+/*
+ * Run the timer interrupt on the current stack. A signal
+ * arriving meanwhile is marked pending and run by the
+ * next loop.
+ */
+static void timerRun()
+{
+  do
+  {
+    portIrqMasked = 1;
+    portIrqPending = 0;
+    c_pos_intEnter();
+    timerInterrupt();
+    c_pos_intExit();
+    portIrqMasked = 0;
+  }
+  while (portIrqPending);
+}
+
+static void timerSignal()
+{
+  if (portIrqMasked)
+  {
+    portIrqPending = 1;
+    return;
+  }
+
+  timerRun();
+}
+
+/*
+ * Called by portSchedUnlock when a timer signal arrived
+ * while interrupts were disabled.
+ */
+void portIrqReplay(void)
+{
+  timerRun();
+}
+
+#else
+
 static void timerExpiredContext()
 {
+#if PORTCFG_SOFT_IRQ_MASK
+  portIrqMasked = 1;
+#endif
   c_pos_intEnter();
-  c_pos_timerInterrupt();
+  timerInterrupt();
   c_pos_intExit();
   setcontext(&posCurrentTask_g->ucontext);
   assert(0);
 }
 
-static void timerExpired(int sig, siginfo_t *info, void *ucontext)
+/*
+ * Run the timer interrupt on the signal stack. The current
+ * task continues here when it is switched back in.
+ */
+static void timerEnterContext()
 {
-  getcontext(&sigContext);
-  sigContext.uc_stack.ss_sp = sigStack;
-  sigContext.uc_stack.ss_size = sizeof(sigStack);
-  sigContext.uc_stack.ss_flags = 0;
-  sigContext.uc_link = 0;
-  sigfillset(&sigContext.uc_sigmask);
-
-  makecontext(&sigContext, timerExpiredContext, 0);
   swapcontext(&posCurrentTask_g->ucontext, &sigContext);
+#if PORTCFG_SOFT_IRQ_MASK
+  portIrqMasked = 0;
+#endif
 }
 
+static void timerSignal()
+{
+#if PORTCFG_SOFT_IRQ_MASK
+  if (portIrqMasked)
+  {
+    portIrqPending = 1;
+    return;
+  }
+#endif
+  timerEnterContext();
+}
+
+#if PORTCFG_SOFT_IRQ_MASK
+/*
+ * Called by portSchedUnlock when a timer signal arrived
+ * while interrupts were disabled. Interrupts stay disabled
+ * until the interrupt has been run, a signal arriving
+ * meanwhile is replayed by the next loop.
+ */
+void portIrqReplay(void)
+{
+  do
+  {
+    portIrqMasked = 1;
+    portIrqPending = 0;
+    timerEnterContext();
+  }
+  while (portIrqPending);
+}
+#endif
+
+#endif
+
 #if NOSCFG_FEATURE_CONOUT == 1
 /*
  * Console output.
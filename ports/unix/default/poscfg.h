@@ -517,6 +517,19 @@
  */
 #define POSCFG_FEATURE_DEBUGHELP     1
 
+/** Enable power management api.
+ * If this definition is set to 1, the idle task waits for the
+ * next signal in ::p_pos_powerSleep instead of the idle task hook.
+ */
+#define POSCFG_FEATURE_POWER         1
+
+/** Enable tickless idle.
+ * If this definition is set to 1, the periodic timer signal is
+ * replaced by a one-shot timer for the next wakeup while all tasks
+ * sleep. Note that also ::POSCFG_FEATURE_POWER must be set to 1.
+ */
+#define POSCFG_FEATURE_TICKLESS      1
+
 /** @} */
 
 /*---------------------------------------------------------------------------
@@ -527,7 +540,45 @@
  * Stacksizes used on real embedded hardware are usually
  * way too small for unix system. If requested size
  * is less than this use minimum value instead.
+ * With ::POSCFG_TASKSTACKTYPE 2 all stacks have this size.
+ */
+#define PORTCFG_MIN_STACK_SIZE	65535
+
+/** Set the size of the stack pool.
+ * Task stacks are mapped with mmap and have a guard page
+ * below them, so that a stack overflow raises SIGSEGV.
+ * The stack of an exited task is kept for reuse, up to
+ * this count of stacks. Set to 0 to unmap them immediately.
+ */
+#define PORTCFG_STACK_POOL	16
+
+/** Set the size of the signal handler stack.
+ * The timer signal is handled on an own stack. If this value
+ * is less than ::PORTCFG_MIN_STACK_SIZE, the minimum size is used.
+ */
+#define PORTCFG_IRQ_STACK_SIZE	65535
+
+/** Select the scheduler lock mode.
+ * If this is set to 1, ::POS_SCHED_LOCK disables interrupts by
+ * setting a flag in user space. A timer signal arriving while the
+ * flag is set is marked pending and replayed by ::POS_SCHED_UNLOCK.
+ * If set to 0, the timer signal is blocked with sigprocmask, which
+ * costs two system calls for each kernel call.
  */
-#define POSCFG_MIN_STACK_SIZE	65535
+#define PORTCFG_SOFT_IRQ_MASK	1
+
+/** Select the context switch method.
+ * If this is set to 1, tasks are switched by a small assembler
+ * routine that saves only the callee saved registers and the
+ * stack pointer (x86-64 and AArch64, needs ::PORTCFG_SOFT_IRQ_MASK).
+ * The timer interrupt then runs directly in the signal handler.
+ * If set to 0, the portable swapcontext / setcontext functions
+ * are used, which make a system call for each task switch.
+ */
+#if defined(__x86_64__) || defined(__aarch64__)
+#define PORTCFG_FAST_CONTEXT	1
+#else
+#define PORTCFG_FAST_CONTEXT	0
+#endif
 
 #endif /* _POSCFG_H */
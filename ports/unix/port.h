@@ -67,9 +67,17 @@
  * This define is responsible for the maximum count of tasks
  * the operating system can manage. For example:
  * @e char = 8 bit, 8 * 8 = 64 tasks;
- * @e long = 32 bit, 32 * 32 = 1024 tasks.
+ * @e long = 32 bit, 32 * 32 = 1024 tasks;
+ * @e long = 64 bit, 64 * 64 = 4096 tasks.
+ * The unix port uses @e long on 64 bit hosts, so 64 priorities
+ * with 64 round robin slots each and 63 flags per flag object
+ * are possible there.
  */
+#if defined(__LP64__)
+#define MVAR_t                long
+#else
 #define MVAR_t                int
+#endif
 
 /** Machine variable width.
  * This define tells the Operating System how much
@@ -78,7 +86,11 @@
  * position, but some others don't. For example, set
  * this define to 8 (bits) if ::MVAR_t is defined to @e char.
  */
+#if defined(__LP64__)
+#define MVAR_BITS              64  /* = (sizeof(MVAR_t) * 8) */
+#else
 #define MVAR_BITS              32  /* = (sizeof(MVAR_t) * 8) */
+#endif
 
 /** Integer variable type used for memory pointers.
  * This define must be set to an integer type that has the
@@ -93,6 +105,11 @@
 #define MPTR_t                int
 #endif
 
+/**
+ * This port has port_ex.h.
+ */
+#define POSCFG_PORT_H_EX        1
+
 /** Required memory alignment on the target CPU.
  * To reach maximum speed, some architecures need correctly
  * aligned memory patterns. Set this define to the memory
@@ -136,8 +153,12 @@
  * 
  * @note the functions ::posTaskCreate, ::posInit and ::p_pos_initTask
  * have different prototypes for each stack handling type.
+ * This port supports all three types, type 2 uses stacks
+ * of ::PORTCFG_MIN_STACK_SIZE bytes.
  */
+#ifndef POSCFG_TASKSTACKTYPE
 #define POSCFG_TASKSTACKTYPE     1
+#endif
 
 /** Enable call to function ::p_pos_initArch.
  * When this define is set to 1, the operating system will call
@@ -233,7 +254,7 @@
  * "register VAR_t flags;" would be added to each function
  * using the macros ::POS_SCHED_LOCK and ::POS_SCHED_UNLOCK.
  */
-#define POSCFG_LOCK_FLAGSTYPE    sigset_t
+#define POSCFG_LOCK_FLAGSTYPE    PortLockFlags
 
 /** Scheduler locking.
  * Locking the scheduler for a short time is done by
@@ -242,13 +263,13 @@
  * code that stores the processor state and disables
  * the interrupts. See ::POSCFG_LOCK_FLAGSTYPE for more details.
  */
-#define POS_SCHED_LOCK           p_pos_blockSigs(&flags)
+#define POS_SCHED_LOCK           { flags = portSchedLock(); (void) flags; }
 
 /** Scheduler unlocking.
  * This is the counterpart macro of ::POS_SCHED_LOCK. It restores
  * the saved processor flags and reenables the interrupts this way.
  */
-#define POS_SCHED_UNLOCK         p_pos_unblockSigs(&flags)
+#define POS_SCHED_UNLOCK         { portSchedUnlock(flags); }
 
 
 /** @} */
@@ -300,6 +321,25 @@
  */
 #define POSCFG_FBIT_BITSHIFT         1
 
+/** Generic finbit configuration, compiler builtins.
+ * If this define is set to 1 and the compiler is GCC or clang,
+ * findbit is done inline with the builtin that counts trailing
+ * zeros (one instruction on most 32 and 64 bit machines).
+ * Round robin findbit then needs one rotate and one such count.
+ * For other compilers the de Bruijn method is used instead,
+ * see ::POSCFG_FBIT_DEBRUIJN.
+ */
+#define POSCFG_FBIT_USE_BUILTIN      1
+
+/** Generic finbit configuration, de Bruijn multiplication.
+ * If this define is set to 1, findbit isolates the lowest set
+ * bit and multiplies it with a de Bruijn constant. The top bits
+ * of the product index a table of ::MVAR_BITS bytes. This needs
+ * no branches, but a fast multiplier, and ::MVAR_BITS must be
+ * 16, 32 or 64.
+ */
+#define POSCFG_FBIT_DEBRUIJN         0
+
 /** @} */
 
 
@@ -359,27 +399,35 @@
 #define POS_USERTASKDATA  void *stackptr;
 #else
 
+/*
+ * poscfg.h is included after this file, so the task data
+ * is selected by pasting the value of PORTCFG_FAST_CONTEXT.
+ * If poscfg.h does not define it, ucontext is used.
+ */
+#define POS_USERTASKDATA PORT_TASKDATA(PORTCFG_FAST_CONTEXT)
+#define PORT_TASKDATA(fast) PORT_TASKDATA_X(fast)
+#define PORT_TASKDATA_X(fast) PORT_TASKDATA_##fast
+#define PORT_TASKDATA_PORTCFG_FAST_CONTEXT PORT_TASKDATA_0
+
 #if (POSCFG_TASKSTACKTYPE == 0)
 
-#define POS_USERTASKDATA \
-   ucontext_t	ucontext; \
-   ucontext_t	uexit;
+#define PORT_TASKDATA_0 \
+   ucontext_t	ucontext;
 
-#elif (POSCFG_TASKSTACKTYPE == 1)
+#define PORT_TASKDATA_1 \
+   void             *stackptr;
 
-#define POS_USERTASKDATA \
+#else
+
+#define PORT_TASKDATA_0 \
    ucontext_t	ucontext; \
    unsigned char    *stack; \
-   UINT_t           stackSize; \
-   ucontext_t	uexit;
-
-#elif (POSCFG_TASKSTACKTYPE == 2)
+   UINT_t           stackSize;
 
-#define FIXED_STACK_SIZE 200
-#define POS_USERTASKDATA \
-   ucontext_t	ucontext; \
-   ucontext_t	uexit; \
-   unsigned char stack[FIXED_STACK_SIZE];
+#define PORT_TASKDATA_1 \
+   void             *stackptr; \
+   unsigned char    *stack; \
+   UINT_t           stackSize;
 
 #endif
 
@@ -395,12 +443,6 @@
 #define NULL ((void*)0)
 #endif
 
-/**
- * To detect stack overflows, fill stack area with
- * PORT_STACK_MAGIC during initialization.
- */
-#define PORT_STACK_MAGIC       0x56
-
 void p_pos_blockSigs(sigset_t* old);
 void p_pos_unblockSigs(sigset_t* old);
 extern void p_pos_idleTaskHook(void);
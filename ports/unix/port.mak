@@ -81,7 +81,7 @@ OPT_LD_SEP   =
 OPT_LD_PFOBJ =
 OPT_LD_PFLIB =
 OPT_LD_FIRST =
-OPT_LD_LAST  =
+OPT_LD_LAST  = -lrt
 
 # Set global defines for compiler / assembler
 CDEFINES = GCC
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2011-2013, Ari Suutari <ari@stonepile.fi>.
+ * All rights reserved. 
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote
+ *     products derived from this software without specific prior written
+ *     permission. 
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ * INDIRECT,  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file    port_ex.h
+ *
+ * This file is originally from the pico]OS realtime operating system
+ * (http://picoos.sourceforge.net).
+ */
+
+
+#ifndef _PORT_EX_H
+#define _PORT_EX_H
+
+#include <signal.h>
+
+/*
+ * Scheduler lock mode, see PORTCFG_SOFT_IRQ_MASK in poscfg.h.
+ * Defaults to the user space interrupt mask if not set there.
+ */
+#ifndef PORTCFG_SOFT_IRQ_MASK
+#define PORTCFG_SOFT_IRQ_MASK 1
+#endif
+
+/*
+ * Count of task stacks kept for reuse, see poscfg.h.
+ */
+#ifndef PORTCFG_STACK_POOL
+#define PORTCFG_STACK_POOL 16
+#endif
+
+/*
+ * Context switch method, see PORTCFG_FAST_CONTEXT in poscfg.h.
+ */
+#ifndef PORTCFG_FAST_CONTEXT
+#define PORTCFG_FAST_CONTEXT 0
+#endif
+
+#if PORTCFG_FAST_CONTEXT
+#if !defined(__x86_64__) && !defined(__aarch64__)
+#error PORTCFG_FAST_CONTEXT is only supported on x86-64 and AArch64
+#endif
+#if !PORTCFG_SOFT_IRQ_MASK
+#error PORTCFG_FAST_CONTEXT needs PORTCFG_SOFT_IRQ_MASK
+#endif
+#endif
+
+#if PORTCFG_SOFT_IRQ_MASK
+
+/*
+ * Interrupts are "disabled" by setting a flag. The timer signal
+ * handler checks the flag and marks the interrupt pending when
+ * it is set, unlocking replays the pending interrupt.
+ * This avoids two sigprocmask system calls for each kernel call.
+ */
+typedef sig_atomic_t PortLockFlags;
+
+extern volatile sig_atomic_t portIrqMasked;
+extern volatile sig_atomic_t portIrqPending;
+
+void portIrqReplay(void);
+
+#define portCompilerBarrier() __asm__ __volatile__ ("" ::: "memory")
+
+static inline __attribute__((always_inline)) PortLockFlags portSchedLock(void)
+{
+  PortLockFlags flags = portIrqMasked;
+
+  portIrqMasked = 1;
+  portCompilerBarrier();
+  return flags;
+}
+
+static inline __attribute__((always_inline)) void portSchedUnlock(PortLockFlags flags)
+{
+  portCompilerBarrier();
+  portIrqMasked = flags;
+  if (!flags && portIrqPending)
+    portIrqReplay();
+}
+
+#else
+
+typedef sigset_t PortLockFlags;
+
+static inline __attribute__((always_inline)) PortLockFlags portSchedLock(void)
+{
+  PortLockFlags flags;
+
+  p_pos_blockSigs(&flags);
+  return flags;
+}
+
+static inline __attribute__((always_inline)) void portSchedUnlock(PortLockFlags flags)
+{
+  p_pos_unblockSigs(&flags);
+}
+
+#endif
+
+#endif /* _PORT_EX_H */
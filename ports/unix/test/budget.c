@@ -0,0 +1,93 @@
+/*
+ *  pico]OS unix port test: execution budgets
+ *
+ *  A runaway task of middle priority never blocks. A task of low
+ *  priority counts the timer ticks it gets to see while it runs.
+ *  In the first run the runaway task has no budget and starves the
+ *  low task, in the second run it has a budget of BUDGET ticks per
+ *  PERIOD ticks. The test prints the ticks both tasks got and the
+ *  overrun count of the runaway task.
+ *
+ *  Build the test with
+ *  make TEST=budget EXTRA_CFLAGS=-DPOSCFG_FEATURE_BUDGET=1
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_BUDGET == 0
+#error The feature POSCFG_FEATURE_BUDGET is not enabled!
+#endif
+
+#define PRIO_TEST     4
+#define PRIO_RUNAWAY  3
+#define PRIO_LOW      2
+
+#define BUDGET    3        /* ticks per period */
+#define PERIOD    10       /* ticks */
+#define RUNTIME   30       /* ticks per run */
+
+static volatile int  stop_g;
+static volatile int  ticks_g[2];
+
+
+static void spintask(void *arg)
+{
+  int    n = (int)(long) arg;
+  JIF_t  last = jiffies;
+
+  while (!stop_g)
+  {
+    if (jiffies != last)
+    {
+      last = jiffies;
+      ++ticks_g[n];
+    }
+  }
+  posTaskExit();
+}
+
+
+static void run(UINT_t budget)
+{
+  POSTASK_t  runaway;
+
+  stop_g = 0;
+  ticks_g[0] = ticks_g[1] = 0;
+
+  runaway = posTaskCreate(spintask, (void*) 0, PRIO_RUNAWAY, 0);
+  posTaskSetBudget(runaway, budget, PERIOD);
+  posTaskCreate(spintask, (void*) 1, PRIO_LOW, 0);
+  posTaskSleep(RUNTIME);
+
+  nosPrintf4("budget %i/%i: runaway %i ticks, low task %i ticks, ",
+             (int) budget, PERIOD, ticks_g[0], ticks_g[1]);
+  nosPrintf1("%i overruns\n", (int) posTaskOverrunCount(runaway));
+
+  stop_g = 1;
+  posTaskSetBudget(runaway, 0, 0);
+  posTaskSleep(2);
+}
+
+
+static void firsttask(void *arg)
+{
+  (void) arg;
+
+  run(0);
+  run(BUDGET);
+  exit(0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, PRIO_TEST, 0, 0);
+  return 0;
+}
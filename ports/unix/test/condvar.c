@@ -0,0 +1,145 @@
+/*
+ *  pico]OS unix port test: condition variable broadcast
+ *
+ *  A group of worker tasks with a higher priority than the test task
+ *  waits for a new round. The test task starts the rounds once with
+ *  posCondBroadcast and once with a posSemaSignal loop, and prints
+ *  the average time until all workers have run. The broadcast makes
+ *  all workers ready before the scheduler runs, so a round needs one
+ *  task switch per worker. With the semaphore loop every signal
+ *  preempts the test task, so a round needs two switches per worker.
+ *
+ *  Build the test with
+ *  make TEST=condvar EXTRA_CFLAGS=-DPOSCFG_FEATURE_CONDVARS=1
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_CONDVARS == 0
+#error The feature POSCFG_FEATURE_CONDVARS is not enabled!
+#endif
+
+/* All workers share one priority above the test task, so a round
+   ends only when each of them has run, and a broadcast makes them
+   ready in the same row. The workers are at or above
+   POSCFG_REALTIME_PRIO of the default config: else soft multitasking
+   would collect up to POSCFG_CTXSW_COMBINE semaphore signals before
+   switching, and the semaphore loop would not preempt per worker. */
+#define PRIO_TEST     11
+#define PRIO_WORKER   12
+
+#define WORKERS        6   /* count of worker tasks     */
+#define ROUNDS     20000   /* count of measured rounds  */
+
+static POSMUTEX_t      mutex_g;
+static POSCOND_t       cond_g;
+static POSSEMA_t       sema_g;
+static volatile int    round_g;
+static volatile int    done_g;
+static volatile int    semaphase_g;
+
+
+static void workerTask(void *arg)
+{
+  int myround = 0;
+
+  (void) arg;
+
+  posMutexLock(mutex_g);
+  while (!semaphase_g)
+  {
+    while (round_g == myround)
+      posCondWait(cond_g, mutex_g, INFINITE);
+    myround = round_g;
+    ++done_g;
+  }
+  posMutexUnlock(mutex_g);
+
+  for (;;)
+  {
+    posSemaGet(sema_g);
+    ++done_g;
+  }
+}
+
+
+static long measure(int broadcast)
+{
+  long t;
+  int  r, i;
+
+  t = testTimeUs();
+  for (r = 0; r < ROUNDS; ++r)
+  {
+    done_g = 0;
+    if (broadcast)
+    {
+      posMutexLock(mutex_g);
+      ++round_g;
+      posMutexUnlock(mutex_g);
+      posCondBroadcast(cond_g);
+    }
+    else
+    {
+      for (i = 0; i < WORKERS; ++i)
+        posSemaSignal(sema_g);
+    }
+    if (done_g != WORKERS)
+      testFail("Not all workers have run!\n");
+  }
+  t = testTimeUs() - t;
+
+  return (t * 1000L) / ROUNDS;
+}
+
+
+static void firsttask(void *arg)
+{
+  long tc, ts;
+  int  i;
+
+  (void) arg;
+
+  mutex_g = posMutexCreate();
+  cond_g  = posCondCreate();
+  sema_g  = posSemaCreate(0);
+  testSetup((mutex_g != NULL) && (cond_g != NULL) && (sema_g != NULL));
+
+  for (i = 0; i < WORKERS; ++i)
+  {
+    if (nosTaskCreate(workerTask, NULL, PRIO_WORKER, 0, NULL) == NULL)
+      testFail("Failed to create the tasks!\n");
+  }
+
+  /* let the workers run up to their first wait */
+  posTaskSleep(MS(50));
+  tc = measure(1);
+
+  /* switch the workers over to the semaphore */
+  posMutexLock(mutex_g);
+  semaphase_g = 1;
+  ++round_g;
+  posMutexUnlock(mutex_g);
+  posCondBroadcast(cond_g);
+  ts = measure(0);
+
+  nosPrintf1("workers:             %i\n", WORKERS);
+  nosPrintf1("posCondBroadcast:    %i ns per round\n", (int) tc);
+  nosPrintf1("posSemaSignal loop:  %i ns per round\n", (int) ts);
+  exit(0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, PRIO_TEST, 0, 0);
+  return 0;
+}
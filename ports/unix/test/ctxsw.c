@@ -0,0 +1,78 @@
+/*
+ *  pico]OS unix port test: task switch time
+ *
+ *  Two tasks pass a token back and forth through two semaphores,
+ *  so each round makes two task switches. The test prints the
+ *  average time of one switch (including the semaphore calls)
+ *  and the size of the task control block.
+ *
+ *  To compare both context switch methods of the port, build and
+ *  run the test once as it is, then set PORTCFG_FAST_CONTEXT to 0
+ *  in ports/unix/default/poscfg.h, remove the obj and lib
+ *  directories in the picoos root and build it again.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+
+#define ROUNDS   1000000  /* count of round trips */
+
+static POSSEMA_t  ping_g;
+static POSSEMA_t  pong_g;
+
+
+static void pongTask(void *arg)
+{
+  (void) arg;
+
+  for (;;)
+  {
+    posSemaGet(ping_g);
+    posSemaSignal(pong_g);
+  }
+}
+
+
+static void firsttask(void *arg)
+{
+  long t;
+  long i;
+
+  (void) arg;
+
+  ping_g = posSemaCreate(0);
+  pong_g = posSemaCreate(0);
+  testSetup((ping_g != NULL) && (pong_g != NULL) &&
+            (nosTaskCreate(pongTask, NULL, 2, 0, "pong") != NULL));
+
+  t = testTimeUs();
+  for (i = 0; i < ROUNDS; ++i)
+  {
+    posSemaSignal(ping_g);
+    posSemaGet(pong_g);
+  }
+  t = testTimeUs() - t;
+
+  nosPrintf1("fast context switch: %s\n",
+             PORTCFG_FAST_CONTEXT ? "on" : "off");
+  nosPrintf1("task switch time:    %i ns\n",
+             (int) ((t * 1000L) / (2L * ROUNDS)));
+  nosPrintf1("task control block:  %i bytes\n",
+             (int) sizeof(struct POSTASK));
+  exit(0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, 1, 0, 0);
+  return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ *  pico]OS unix port test: earliest-deadline-first scheduling
+ *
+ *  Two periodic tasks load the CPU to 94%: task 1 runs 4 ticks every
+ *  10 ticks, task 2 runs 7.5 ticks every 14 ticks. In the first run the
+ *  tasks have fixed rate monotonic priorities (the shorter period gets
+ *  the higher priority), in the second run they are created with
+ *  posTaskCreateDeadline. The test prints the count of jobs and of
+ *  missed deadlines for both runs. The load is above the rate
+ *  monotonic bound, so only the EDF run is expected to meet all
+ *  deadlines.
+ *
+ *  Build the test with
+ *  make TEST=edfsched EXTRA_CFLAGS=-DPOSCFG_FEATURE_EDF=1
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_EDF == 0
+#error The feature POSCFG_FEATURE_EDF is not enabled!
+#endif
+
+#define PRIO_TEST     (POSCFG_EDF_PRIO + 3)
+
+#define RUNTIME       70       /* ticks, one hyperperiod of the tasks */
+
+static const UINT_t period_g[2] = { 10, 14 };  /* ticks */
+static const UINT_t load_g[2]   = { 40, 75 };  /* tenths of a tick */
+
+static volatile int     edf_g;
+static volatile int     jobs_g[2];
+static volatile int     misses_g[2];
+static volatile int     done_g;
+static JIF_t            start_g;
+
+
+/*
+ * Use the CPU for the given time. Gaps of more than a millisecond
+ * between two clock readings are time the task was preempted,
+ * they are not counted.
+ */
+static void work(unsigned long long ns)
+{
+  unsigned long long last, now, used = 0;
+
+  last = testTimeNs();
+  while (used < ns)
+  {
+    now = testTimeNs();
+    if (now - last < 1000000)
+      used += now - last;
+    last = now;
+  }
+}
+
+
+static void periodictask(void *arg)
+{
+  int    n = (int)(long) arg;
+  JIF_t  release = start_g;
+  JIF_t  end = start_g + RUNTIME;
+
+  while (POS_TIMEAFTER(end, release + period_g[n]))
+  {
+    work((unsigned long long) load_g[n] * (100000000 / HZ));
+    ++jobs_g[n];
+    if (edf_g)
+    {
+      if (posTaskWaitNextPeriod() == 1)
+        ++misses_g[n];
+      release += period_g[n];
+    }
+    else
+    {
+      if (POS_TIMEAFTER(jiffies, release + period_g[n] + 1))
+        ++misses_g[n];
+      release += period_g[n];
+      if (POS_TIMEAFTER(release, jiffies))
+        posTaskSleep((UINT_t) (release - jiffies));
+    }
+  }
+  ++done_g;
+  posTaskExit();
+}
+
+
+static void run(int edf)
+{
+  int i;
+
+  edf_g = edf;
+  done_g = 0;
+  for (i = 0; i < 2; ++i)
+    jobs_g[i] = misses_g[i] = 0;
+
+  posTaskSleep(1);
+  start_g = jiffies;
+  for (i = 0; i < 2; ++i)
+  {
+    if (edf)
+      posTaskCreateDeadline(periodictask, (void*)(long) i,
+                            period_g[i], 0, 0);
+    else
+      posTaskCreate(periodictask, (void*)(long) i,
+                    POSCFG_EDF_PRIO + 2 - i, 0);
+  }
+  while (done_g < 2)
+    posTaskSleep(HZ);
+
+  nosPrintf3("%s: %i jobs, %i missed deadlines\n",
+             edf ? "EDF          " : "fixed priority",
+             jobs_g[0] + jobs_g[1], misses_g[0] + misses_g[1]);
+}
+
+
+static void firsttask(void *arg)
+{
+  (void) arg;
+
+  run(0);
+  run(1);
+  exit(0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, PRIO_TEST, 0, 0);
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ *  pico]OS unix port test: findbit speed
+ *
+ *  Measures the time of a scheduler decision, that is the two
+ *  findbit calls pos_schedule needs to pick the next task from
+ *  the ready bitmaps (first the priority, then the task within
+ *  the priority, starting at the round robin offset). The
+ *  results are checked against a simple bit loop.
+ *
+ *  To compare the findbit methods, build and run the test once
+ *  as it is, then change POSCFG_FBIT_USE_BUILTIN and
+ *  POSCFG_FBIT_DEBRUIJN in ports/unix/port.h, remove the obj and
+ *  lib directories in the picoos root and build it again.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+
+#define STATES      4096   /* count of random ready bitmaps */
+#define ROUNDS      2000   /* passes over all bitmaps       */
+
+static UVAR_t  ymask_g[STATES];
+static UVAR_t  xtable_g[STATES][MVAR_BITS];
+static UVAR_t  rr_g[STATES];
+
+
+static UVAR_t randomBits(void)
+{
+  UVAR_t bits;
+  int    i;
+
+  /* few bits set, like in a real ready table */
+  do
+  {
+    bits = 0;
+    for (i = rand() % 3; i >= 0; --i)
+      bits |= (UVAR_t) 1 << (rand() % MVAR_BITS);
+  }
+  while (bits == 0);
+
+  return bits;
+}
+
+
+static UVAR_t slowFindbit(UVAR_t bits, UVAR_t start)
+{
+  UVAR_t i, b;
+
+  for (i = 0; i < MVAR_BITS; ++i)
+  {
+    b = (start + i) & (MVAR_BITS - 1);
+    if (bits & ((UVAR_t) 1 << b))
+      return b;
+  }
+
+  return 0;
+}
+
+
+static void firsttask(void *arg)
+{
+  UVAR_t  ym, xt, sum = 0;
+  long    t, r;
+  int     s, errors = 0;
+
+  (void) arg;
+
+  for (s = 0; s < STATES; ++s)
+  {
+    ymask_g[s] = randomBits();
+    for (ym = 0; ym < MVAR_BITS; ++ym)
+      xtable_g[s][ym] = randomBits();
+    rr_g[s] = (UVAR_t) (rand() % MVAR_BITS);
+  }
+
+  for (s = 0; s < STATES; ++s)
+  {
+    ym = POS_FINDBIT(ymask_g[s]);
+    xt = POS_FINDBIT_EX(xtable_g[s][ym], rr_g[s]);
+    if ((ym != slowFindbit(ymask_g[s], 0)) ||
+        (xt != slowFindbit(xtable_g[s][ym],
+                           POSCFG_ROUNDROBIN ? rr_g[s] : 0)))
+      ++errors;
+  }
+
+  t = testTimeUs();
+  for (r = 0; r < ROUNDS; ++r)
+  {
+    for (s = 0; s < STATES; ++s)
+    {
+      ym = POS_FINDBIT(ymask_g[s]);
+      xt = POS_FINDBIT_EX(xtable_g[s][ym], rr_g[s]);
+      sum += ym * MVAR_BITS + xt;
+    }
+  }
+  t = testTimeUs() - t;
+
+  nosPrintf1("findbit method:      %s\n",
+             SYS_FBIT_BUILTIN ? "compiler builtin" :
+             ((POSCFG_FBIT_USE_BUILTIN || POSCFG_FBIT_DEBRUIJN) ?
+              "de Bruijn" : "generic"));
+  nosPrintf1("round robin:         %s\n",
+             POSCFG_ROUNDROBIN ? "on" : "off");
+  nosPrintf1("scheduler decision:  %i ps\n",
+             (int) ((t * 1000000.0) / ((double) ROUNDS * STATES)));
+  nosPrintf1("errors:              %i\n", errors);
+  nosPrintf1("(checksum %u)\n", (unsigned int) sum);
+  exit(errors != 0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, 1, 0, 0);
+  return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ *  pico]OS unix port test: high resolution sleep
+ *
+ *  The test task sleeps SLEEP_US microseconds, WAKEUPS times in a
+ *  row. In the first run it uses posTaskSleep(1), the shortest
+ *  sleep the timer tick allows. In the second run it uses
+ *  posTaskSleepNs, which is served by the high resolution compare
+ *  interrupt. The test prints the average and the worst sleep time
+ *  for both runs.
+ *
+ *  Build the test with
+ *  make TEST=hirestmr EXTRA_CFLAGS=-DPOSCFG_FEATURE_HIRESTIMER=1
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_HIRESTIMER == 0
+#error The feature POSCFG_FEATURE_HIRESTIMER is not enabled!
+#endif
+
+#define PRIO_TEST     11
+
+#define SLEEP_US  250      /* requested sleep time */
+#define WAKEUPS   20       /* count of measured sleeps */
+
+
+static void measure(int hires, long *avg, long *max)
+{
+  NSEC_t t, d, sum;
+  int    i;
+
+  sum = 0;
+  *max = 0;
+  posTaskSleep(1);
+  for (i = 0; i < WAKEUPS; ++i)
+  {
+    t = p_pos_hiresNow();
+    if (hires)
+      posTaskSleepNs((NSEC_t) SLEEP_US * 1000);
+    else
+      posTaskSleep(1);
+    d = (p_pos_hiresNow() - t) / 1000;
+    sum += d;
+    if ((long) d > *max)
+      *max = (long) d;
+  }
+  *avg = (long) (sum / WAKEUPS);
+}
+
+
+static void firsttask(void *arg)
+{
+  long avgt, maxt, avgh, maxh;
+
+  (void) arg;
+
+  measure(0, &avgt, &maxt);
+  measure(1, &avgh, &maxh);
+
+  nosPrintf2("posTaskSleep(1):     %i us average, %i us worst\n",
+             (int) avgt, (int) maxt);
+  nosPrintf3("posTaskSleepNs(%ius): %i us average, %i us worst\n",
+             SLEEP_US, (int) avgh, (int) maxh);
+  exit(0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, PRIO_TEST, 0, 0);
+  return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ *  pico]OS unix port test: kernel call rate
+ *
+ *  A single task calls semaphore, mutex and atomic variable
+ *  functions in a loop that never blocks, and prints the count of
+ *  kernel calls per second. Each call locks and unlocks the
+ *  scheduler once, so the result mainly shows the cost of
+ *  POS_SCHED_LOCK / POS_SCHED_UNLOCK.
+ *
+ *  To compare both lock modes of the port, build and run the test
+ *  once as it is, then set PORTCFG_SOFT_IRQ_MASK to 0 in
+ *  ports/unix/default/poscfg.h, remove the obj and lib directories
+ *  in the picoos root and build it again.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_MUTEXES == 0
+#error The feature POSCFG_FEATURE_MUTEXES is not enabled!
+#endif
+#if POSCFG_FEATURE_ATOMICVAR == 0
+#error The feature POSCFG_FEATURE_ATOMICVAR is not enabled!
+#endif
+
+#define RUN_MS        2000  /* duration of the measurement      */
+#define LOOPS         1000  /* loops between clock reads        */
+#define CALLS_PER_LOOP   5  /* kernel calls in the loop body    */
+
+
+static void firsttask(void *arg)
+{
+  POSSEMA_t   sema;
+  POSMUTEX_t  mutex;
+  POSATOMIC_t atomic;
+  long        start, t;
+  unsigned long calls = 0;
+  int         i;
+
+  (void) arg;
+
+  sema  = posSemaCreate(0);
+  mutex = posMutexCreate();
+  testSetup((sema != NULL) && (mutex != NULL));
+  posAtomicSet(&atomic, 0);
+
+  start = testTimeUs();
+  do
+  {
+    for (i = 0; i < LOOPS; ++i)
+    {
+      posSemaSignal(sema);
+      posSemaGet(sema);
+      posMutexLock(mutex);
+      posMutexUnlock(mutex);
+      posAtomicAdd(&atomic, 1);
+    }
+    calls += LOOPS * CALLS_PER_LOOP;
+    t = testTimeUs() - start;
+  }
+  while (t < RUN_MS * 1000L);
+
+  nosPrintf1("user space interrupt mask: %s\n",
+             PORTCFG_SOFT_IRQ_MASK ? "on" : "off");
+  nosPrintf1("kernel calls per second:   %lu\n",
+             (unsigned long) ((double) calls * 1000000.0 / (double) t));
+  exit(0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, 1, 0, 0);
+  return 0;
+}
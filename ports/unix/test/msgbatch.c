@@ -0,0 +1,146 @@
+/*
+ *  pico]OS unix port test: sending messages in batches
+ *
+ *  The test task sends messages to a receiver task of higher
+ *  priority. In the first run each message is sent with
+ *  posMessageSend and received with posMessageGet, so every message
+ *  costs two task switches. In the second run the messages are sent
+ *  with posMessageSendBatch in groups of BATCH and received with
+ *  posMessageGetAll. The test prints the messages per second for
+ *  both runs.
+ *
+ *  Build the test with
+ *  make TEST=msgbatch EXTRA_CFLAGS=-DPOSCFG_FEATURE_MSGBATCH=1
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_MSGBATCH == 0
+#error The feature POSCFG_FEATURE_MSGBATCH is not enabled!
+#endif
+#if POSCFG_MAX_MESSAGES < 4
+#error This test needs at least 4 message buffers!
+#endif
+
+/* The receiver runs above the test task, so it frees each message
+   or batch before the test task allocates the next one and the
+   small message pool never runs out. It is at or above
+   POSCFG_REALTIME_PRIO of the default config: soft multitasking
+   would else collect several sends before switching, and the
+   first run would not pay a task switch per message. */
+#define PRIO_TEST     11
+#define PRIO_RECEIVER 12
+
+#define MESSAGES  400000   /* count of measured messages */
+#define BATCH     4        /* messages per batch, the default pool size */
+
+static POSTASK_t       receiver_g;
+static volatile long   count_g;
+static volatile int    batch_g;
+
+
+static void receiverTask(void *arg)
+{
+  void  *msg, *next;
+
+  (void) arg;
+
+  for (;;)
+  {
+    if (!batch_g)
+    {
+      msg = posMessageGet();
+      posMessageFree(msg);
+      ++count_g;
+      continue;
+    }
+
+    msg = posMessageGetAll();
+    while (msg != NULL)
+    {
+      next = posMessageNext(msg);
+      posMessageFree(msg);
+      ++count_g;
+      msg = next;
+    }
+  }
+}
+
+
+static void* allocMessage(void)
+{
+  void  *msg;
+
+  msg = posMessageAlloc();
+  if (msg == NULL)
+    testFail("Out of message buffers!\n");
+  return msg;
+}
+
+
+static long measure(void)
+{
+  void  *bufs[BATCH];
+  long  t, i, j;
+
+  count_g = 0;
+  t = testTimeUs();
+  if (!batch_g)
+  {
+    for (i = 0; i < MESSAGES; ++i)
+      posMessageSend(allocMessage(), receiver_g);
+  }
+  else
+  {
+    for (i = 0; i < MESSAGES; i += BATCH)
+    {
+      for (j = 0; j < BATCH; ++j)
+        bufs[j] = allocMessage();
+      posMessageSendBatch(bufs, BATCH, receiver_g);
+    }
+  }
+  t = testTimeUs() - t;
+
+  if (count_g != MESSAGES)
+    testFail("Messages got lost!\n");
+  return (t > 0) ? (long) (((double) MESSAGES * 1000000.0) / t) : 0;
+}
+
+
+static void firsttask(void *arg)
+{
+  long ms, mb;
+
+  (void) arg;
+
+  receiver_g = posTaskCreate(receiverTask, NULL, PRIO_RECEIVER, 0);
+  if (receiver_g == NULL)
+    testFail("Failed to create the receiver task!\n");
+  posTaskSleep(MS(10));
+  ms = measure();
+
+  /* switch the receiver over to posMessageGetAll */
+  batch_g = 1;
+  posMessageSend(allocMessage(), receiver_g);
+  posTaskSleep(MS(10));
+  mb = measure();
+
+  nosPrintf1("posMessageSend:      %i messages per second\n", (int) ms);
+  nosPrintf1("posMessageSendBatch: %i messages per second\n", (int) mb);
+  exit(0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, PRIO_TEST, 0, 0);
+  return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ *  pico]OS unix port test: mutex priority inheritance
+ *
+ *  A low and a high priority task share a mutex, while a medium
+ *  priority task burns CPU time. The test measures the worst case
+ *  time the high priority task is blocked in posMutexLock.
+ *  Without priority inheritance the medium priority task delays the
+ *  low priority task that holds the mutex (priority inversion), so
+ *  the blocking time grows up to CRITICAL_MS + MEDIUM_MS. With
+ *  POSCFG_MUTEX_PRIO_INHERIT set to 1 it is bounded by CRITICAL_MS.
+ *  With POSCFG_FEATURE_MUTEXCEILING set to 1 the test uses a mutex
+ *  with a ceiling at the priority of the high priority task instead.
+ *
+ *  To compare both, build and run the test once as it is, then
+ *  remove the obj and lib directories in the picoos root and build
+ *  it again with  make EXTRA_CFLAGS=-DPOSCFG_MUTEX_PRIO_INHERIT=1
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_MUTEXES == 0
+#error The feature POSCFG_FEATURE_MUTEXES is not enabled!
+#endif
+
+/* Priorities are above POSCFG_REALTIME_PRIO of the default config,
+   so that each wakeup is served immediately. */
+#define PRIO_LOW      10
+#define PRIO_MEDIUM   11
+#define PRIO_HIGH     12
+
+#define CRITICAL_MS  150   /* time the low prio task holds the mutex  */
+#define MEDIUM_MS    400   /* CPU time burnt by the medium prio task  */
+#define ROUNDS        40   /* count of measurements                   */
+
+static POSMUTEX_t      mutex_g;
+static unsigned long   loopsPerMs_g;
+
+
+/* Burn CPU time. A loop count is used instead of the clock,
+   so that time spent in other tasks is not counted. */
+static void spin(unsigned int ms)
+{
+  volatile unsigned long i;
+  unsigned long n = loopsPerMs_g * ms;
+
+  for (i = 0; i < n; ++i);
+}
+
+
+static void calibrate(void)
+{
+  volatile unsigned long i;
+  long t;
+
+  posTaskSchedLock();
+  t = testTimeUs();
+  for (i = 0; i < 10000000UL; ++i);
+  t = testTimeUs() - t;
+  posTaskSchedUnlock();
+  loopsPerMs_g = (10000000UL * 1000UL) / (unsigned long) (t + 1);
+}
+
+
+static void lowTask(void *arg)
+{
+  (void) arg;
+
+  for (;;)
+  {
+    posMutexLock(mutex_g);
+    spin(CRITICAL_MS);
+    posMutexUnlock(mutex_g);
+    posTaskSleep(1);
+  }
+}
+
+
+static void mediumTask(void *arg)
+{
+  (void) arg;
+
+  for (;;)
+  {
+    posTaskSleep(MS(300));
+    spin(MEDIUM_MS);
+  }
+}
+
+
+static void highTask(void *arg)
+{
+  long t, worst = 0;
+  int  i;
+
+  (void) arg;
+
+  for (i = 0; i < ROUNDS; ++i)
+  {
+    posTaskSleep(MS(100));
+    t = testTimeUs();
+    posMutexLock(mutex_g);
+    t = testTimeUs() - t;
+    posMutexUnlock(mutex_g);
+    if (t > worst)
+      worst = t;
+  }
+
+  nosPrintf1("priority inheritance: %s\n",
+             POSCFG_MUTEX_PRIO_INHERIT ? "on" : "off");
+  nosPrintf1("priority ceiling:     %s\n",
+             POSCFG_FEATURE_MUTEXCEILING ? "on" : "off");
+  nosPrintf1("critical section:     %i ms\n", CRITICAL_MS);
+  nosPrintf1("worst case blocking:  %i ms\n", (int) (worst / 1000));
+  exit(0);
+}
+
+
+static void firsttask(void *arg)
+{
+  (void) arg;
+
+  calibrate();
+#if POSCFG_FEATURE_MUTEXCEILING != 0
+  mutex_g = posMutexCreateCeiling(PRIO_HIGH);
+#else
+  mutex_g = posMutexCreate();
+#endif
+  testSetup((mutex_g != NULL) &&
+            (nosTaskCreate(lowTask, NULL, PRIO_LOW, 0, "low") != NULL) &&
+            (nosTaskCreate(mediumTask, NULL, PRIO_MEDIUM, 0, "medium") != NULL) &&
+            (nosTaskCreate(highTask, NULL, PRIO_HIGH, 0, "high") != NULL));
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, 1, 0, 0);
+  return 0;
+}
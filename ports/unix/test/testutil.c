@@ -0,0 +1,43 @@
+/*
+ *  pico]OS unix port test: common helper functions
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <time.h>
+#include <picoos.h>
+#include "testutil.h"
+
+
+long testTimeUs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (long) ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+
+unsigned long long testTimeNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long long) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+void testFail(const char *msg)
+{
+  nosPrint(msg);
+  exit(1);
+}
+
+
+void testSetup(int ok)
+{
+  if (!ok)
+    testFail("Failed to set up the test!\n");
+}
@@ -0,0 +1,31 @@
+/*
+ *  pico]OS unix port test: common helper functions
+ *
+ *  The tests in this directory are built together with testutil.c.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#ifndef _TESTUTIL_H
+#define _TESTUTIL_H
+
+/*
+ * Time of the monotonic host clock, in microseconds
+ * or nanoseconds since an arbitrary start point.
+ */
+long testTimeUs(void);
+unsigned long long testTimeNs(void);
+
+/*
+ * Print the message and end the test with an error.
+ */
+void testFail(const char *msg);
+
+/*
+ * End the test with an error if a setup step has failed,
+ * that is if ok is zero.
+ */
+void testSetup(int ok);
+
+#endif /* _TESTUTIL_H */
@@ -0,0 +1,69 @@
+/*
+ *  pico]OS unix port test: tickless idle
+ *
+ *  The test task is the only task besides the idle task. It sleeps
+ *  SLEEP ticks, ROUNDS times in a row, and the idle task suspends
+ *  the periodic tick during each sleep. Before a sleep the test task
+ *  busy waits a growing part of a tick, so the sleeps start at all
+ *  phases of the tick. After each sleep jiffies must have advanced
+ *  by exactly SLEEP, also when a tick arrived just before the idle
+ *  task suspended the tick. The test prints the count of sleeps
+ *  with a wrong count of jiffies.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_TICKLESS == 0
+#error The feature POSCFG_FEATURE_TICKLESS is not enabled!
+#endif
+
+#define SLEEP     2        /* ticks per sleep */
+#define ROUNDS    16       /* count of measured sleeps */
+
+#define TICK_US   (1000000L / HZ)
+
+
+static void firsttask(void *arg)
+{
+  JIF_t  start;
+  long   t;
+  int    i, errors = 0;
+
+  (void) arg;
+
+  for (i = 0; i < ROUNDS; ++i)
+  {
+    /* start right after a tick, then wait up to 3/4 of a tick */
+    posTaskSleep(1);
+    t = testTimeUs();
+    while ((testTimeUs() - t) < (i * 3 * TICK_US) / (4 * ROUNDS));
+
+    start = jiffies;
+    posTaskSleep(SLEEP);
+    if ((JIF_t) (jiffies - start) != SLEEP)
+    {
+      nosPrintf2("sleep %i: jiffies advanced by %i\n",
+                 i, (int) (JIF_t) (jiffies - start));
+      ++errors;
+    }
+  }
+
+  nosPrintf2("sleeps of %i ticks:  %i\n", SLEEP, ROUNDS);
+  nosPrintf1("wrong jiffies count: %i\n", errors);
+  exit(errors != 0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, 1, 0, 0);
+  return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ *  pico]OS unix port test: timer callbacks in the timer daemon
+ *
+ *  A high priority task wakes up with every timer tick. A periodic
+ *  timer fires every second tick and runs a callback that needs
+ *  BURN_US microseconds. In the first run the callback is executed
+ *  from the timer interrupt and delays every second wakeup of the
+ *  task. In the second run a timer daemon task with low priority
+ *  executes the callback. The test prints the wakeup jitter of the
+ *  high priority task for both runs.
+ *
+ *  Build the test with
+ *  make TEST=timerdmn "EXTRA_CFLAGS=-DPOSCFG_FEATURE_TIMERCALLBACK=1 -DPOSCFG_FEATURE_TIMERDAEMON=1"
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_TIMERDAEMON == 0
+#error The feature POSCFG_FEATURE_TIMERDAEMON is not enabled!
+#endif
+
+#define PRIO_DAEMON   1
+#define PRIO_TEST     11
+
+#define BURN_US   5000     /* runtime of the timer callback */
+#define WAKEUPS   30       /* count of measured wakeups */
+
+
+static void burnCallback(POSTIMER_t tmr, void *arg)
+{
+  long t;
+
+  (void) tmr;
+  (void) arg;
+
+  t = testTimeUs();
+  while ((testTimeUs() - t) < BURN_US);
+}
+
+
+static long measure(void)
+{
+  long t0, late, min, max;
+  int  i;
+
+  posTaskSleep(1);
+  t0 = testTimeUs();
+  min = max = 0;
+  for (i = 1; i <= WAKEUPS; ++i)
+  {
+    posTaskSleep(1);
+    late = testTimeUs() - t0 - ((long) i * (1000000L / HZ));
+    if (late < min)
+      min = late;
+    if (late > max)
+      max = late;
+  }
+  return max - min;
+}
+
+
+static void firsttask(void *arg)
+{
+  POSTIMER_t tmr;
+  long ti, td;
+
+  (void) arg;
+
+  tmr = posTimerCreate();
+  if ((tmr == NULL) ||
+      (posTimerCallbackSet(tmr, burnCallback, NULL, 1, 2) != E_OK))
+    testFail("Failed to set up the timer!\n");
+  posTimerStart(tmr);
+  ti = measure();
+
+  if (posTaskCreate(posTimerDaemon, NULL, PRIO_DAEMON, 0) == NULL)
+    testFail("Failed to create the timer daemon!\n");
+  td = measure();
+
+  nosPrintf1("callback in timer interrupt: %i us wakeup jitter\n", (int) ti);
+  nosPrintf1("callback in timer daemon:    %i us wakeup jitter\n", (int) td);
+  exit(0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, PRIO_TEST, 0, 0);
+  return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ *  pico]OS unix port test: waiting for multiple events
+ *
+ *  A gateway task reacts to two semaphores that the test task
+ *  signals in turn. In the first run the gateway waits for both
+ *  with posEventWaitAny. In the second run two relay tasks wait
+ *  for one semaphore each and pass the event on to the gateway
+ *  with posMessageSend, as it was needed without posEventWaitAny.
+ *  The test prints the average time per event for both runs.
+ *
+ *  Build the test with
+ *  make TEST=waitany EXTRA_CFLAGS=-DPOSCFG_FEATURE_EVENTWAITANY=1
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdlib.h>
+#include <picoos.h>
+#include "testutil.h"
+
+#if POSCFG_ENABLE_NANO == 0
+#error This test needs the nano layer!
+#endif
+#if POSCFG_FEATURE_EVENTWAITANY == 0
+#error The feature POSCFG_FEATURE_EVENTWAITANY is not enabled!
+#endif
+#if POSCFG_FEATURE_MSGBOXES == 0
+#error The feature POSCFG_FEATURE_MSGBOXES is not enabled!
+#endif
+
+/* The gateway runs above the test task, so each event is served
+   before the test task signals the next one. The relays are above
+   the gateway: a relay finishes its posMessageSend and waits again
+   before the gateway takes the message. All of them are at or
+   above POSCFG_REALTIME_PRIO of the default config, so soft
+   multitasking does not defer a wakeup along the chain. */
+#define PRIO_TEST     11
+#define PRIO_GATEWAY  12
+#define PRIO_RELAY    13
+
+#define EVENTS    200000   /* count of measured events */
+
+static POSSEMA_t       sema_g[2];
+static POSTASK_t       gateway_g;
+static volatile long   count_g[2];
+static volatile int    relay_g;
+
+
+static void gatewayTask(void *arg)
+{
+  POSWAITOBJ_t objs[2];
+  VAR_t  i;
+  VAR_t  *msg;
+
+  (void) arg;
+
+  objs[0].type   = POSWAIT_SEMA;
+  objs[0].handle = sema_g[0];
+  objs[1].type   = POSWAIT_SEMA;
+  objs[1].handle = sema_g[1];
+
+  while (!relay_g)
+  {
+    i = posEventWaitAny(objs, 2, INFINITE);
+    if ((i == 0) || (i == 1))
+      ++count_g[i];
+  }
+
+  for (;;)
+  {
+    msg = (VAR_t*) posMessageGet();
+    ++count_g[*msg];
+    posMessageFree(msg);
+  }
+}
+
+
+static void relayTask(void *arg)
+{
+  VAR_t  i = (VAR_t) (long) arg;
+  VAR_t  *msg;
+
+  for (;;)
+  {
+    posSemaGet(sema_g[i]);
+    msg = (VAR_t*) posMessageAlloc();
+    if (msg == NULL)
+      testFail("Out of message buffers!\n");
+    *msg = i;
+    posMessageSend(msg, gateway_g);
+  }
+}
+
+
+static long measure(void)
+{
+  long t, i;
+
+  count_g[0] = 0;
+  count_g[1] = 0;
+  t = testTimeUs();
+  for (i = 0; i < EVENTS; ++i)
+    posSemaSignal(sema_g[i & 1]);
+  t = testTimeUs() - t;
+
+  if ((count_g[0] + count_g[1]) != EVENTS)
+    testFail("Events got lost!\n");
+  return (t * 1000L) / EVENTS;
+}
+
+
+static void firsttask(void *arg)
+{
+  long tw, tr;
+
+  (void) arg;
+
+  sema_g[0] = posSemaCreate(0);
+  sema_g[1] = posSemaCreate(0);
+  gateway_g = posTaskCreate(gatewayTask, NULL, PRIO_GATEWAY, 0);
+  testSetup((sema_g[0] != NULL) && (sema_g[1] != NULL) &&
+            (gateway_g != NULL));
+  tw = measure();
+
+  /* switch the gateway over to the message box */
+  relay_g = 1;
+  posSemaSignal(sema_g[0]);
+  if ((posTaskCreate(relayTask, (void*) 0L, PRIO_RELAY, 0) == NULL) ||
+      (posTaskCreate(relayTask, (void*) 1L, PRIO_RELAY, 0) == NULL))
+    testFail("Failed to create the tasks!\n");
+  posTaskSleep(MS(50));
+  tr = measure();
+
+  nosPrintf1("posEventWaitAny:     %i ns per event\n", (int) tw);
+  nosPrintf1("relay tasks:         %i ns per event\n", (int) tr);
+  exit(0);
+}
+
+
+int main(void)
+{
+  nosInit(firsttask, NULL, PRIO_TEST, 0, 0);
+  return 0;
+}
@@ -108,6 +108,9 @@ void POSCALL nosMemSet(void *buf, char val, UINT_t count)
     f |= f << 8;
 #if MVAR_BITS > 16
     f |= f << 16;
+#endif
+#if MVAR_BITS > 32
+    f |= f << 32;
 #endif
     do
     {
@@ -68,6 +68,16 @@
  * POSCFG_FBIT_BITSHIFT = 1:
  *  Set this to 1 if your machine is able to do fast bit shifts.
  *  This is true for most of the bigger machines such as PowerPC.
+ *
+ * POSCFG_FBIT_USE_BUILTIN = 1:
+ *  FINDBIT is defined in picoos.h with the count-trailing-zeros
+ *  builtin of the compiler, this file is then empty. If the
+ *  compiler has no builtins, the de Bruijn function below is used.
+ *
+ * POSCFG_FBIT_DEBRUIJN = 1:
+ *  findbit is done by a de Bruijn multiplication and a table of
+ *  MVAR_BITS bytes. Needs MVAR_BITS of 16, 32 or 64 and a fast
+ *  multiplier.
  */
 
 
@@ -197,21 +207,99 @@ VAR_t const p_pos_fbittbl_rr[8][256] =
 };
 
 
+#elif (SYS_FBIT_BUILTIN != 0)
+
+/* FINDBIT uses compiler builtins, see picoos.h */
+
+#elif (POSCFG_FBIT_DEBRUIJN != 0) || \
+      ((POSCFG_FBIT_USE_BUILTIN != 0) && (MVAR_BITS >= 16))
+
+/*
+ * Generic findbit() -function for 16/32/64 bit architectures,
+ * also used when POSCFG_FBIT_USE_BUILTIN is set but the compiler
+ * has no builtins. The lowest set bit is isolated and multiplied
+ * with a de Bruijn constant, the top bits of the product are
+ * the index into a small table.
+ *
+ * Speed:
+ *  no branches, one multiplication and one table access.
+ *
+ * When roundrobin is enabled, the bitfield is rotated first.
+ */
+
+#if (MVAR_BITS == 16)
+
+#define FBIT_DEBRUIJN  ((UVAR_t) 0x09AFU)
+#define FBIT_SHIFT     12
+
+static const unsigned char fbit_debruijn[16] =
+{ 0, 1, 2, 5, 3, 9, 6,11,15, 4, 8,10,14, 7,13,12 };
+
+#elif (MVAR_BITS == 32)
+
+#define FBIT_DEBRUIJN  ((UVAR_t) 0x077CB531UL)
+#define FBIT_SHIFT     27
+
+static const unsigned char fbit_debruijn[32] =
+{ 0, 1,28, 2,29,14,24, 3,30,22,20,15,25,17, 4, 8,
+ 31,27,13,23,21,19,16, 7,26,12,18, 6,11, 5,10, 9 };
+
+#elif (MVAR_BITS == 64)
+
+#define FBIT_DEBRUIJN  ((UVAR_t) 0x03F79D71B4CB0A89ULL)
+#define FBIT_SHIFT     58
+
+static const unsigned char fbit_debruijn[64] =
+{ 0, 1,48, 2,57,49,28, 3,61,58,50,42,38,29,17, 4,
+ 62,55,59,36,53,51,43,22,45,39,33,30,24,18,12, 5,
+ 63,47,56,27,60,41,37,16,54,35,52,21,44,32,23,11,
+ 46,26,40,15,34,20,31,10,25,14,19, 9,13, 8, 7, 6 };
+
+#else
+#error POSCFG_FBIT_DEBRUIJN needs MVAR_BITS 16, 32 or 64
+#endif
+
+#define FBIT_LOOKUP(bf) \
+  fbit_debruijn[(UVAR_t) (((bf) & (~(bf) + 1)) * FBIT_DEBRUIJN) >> FBIT_SHIFT]
+
+#if (POSCFG_ROUNDROBIN == 0)
+
+UVAR_t POSCALL p_pos_findbit(const UVAR_t bitfield)
+{
+  return FBIT_LOOKUP(bitfield);
+}
+
+#else /* POSCFG_ROUNDROBIN */
+
+UVAR_t POSCALL p_pos_findbit(const UVAR_t bitfield, UVAR_t rrOffset)
+{
+  UVAR_t bf;
+
+  bf = (bitfield >> rrOffset) |
+       (bitfield << ((MVAR_BITS - rrOffset) & (MVAR_BITS - 1)));
+
+  return (FBIT_LOOKUP(bf) + rrOffset) & (MVAR_BITS - 1);
+}
+
+#endif /* POSCFG_ROUNDROBIN */
+
 #else /* POSCFG_FBIT_USE_LUTABLE */
 /*-------------------------------------------------------------------------*/
 
 
-#if (POSCFG_FASTCODE != 0) && (MVAR_BITS <= 32)
+#if (POSCFG_FASTCODE != 0) && \
+    ((MVAR_BITS <= 32) || (POSCFG_FBIT_BITSHIFT != 0))
 #if (POSCFG_FBIT_BITSHIFT != 0)
 
 /*
- * Fast generic findbit() -function for 8/16/32 bit architectures.
+ * Fast generic findbit() -function for 8/16/32/64 bit architectures.
  * The code supports roundrobin and standard-scheduling.
  *
  * Speed:
  *   8 bit: 3 if-branches
  *  16 bit: 4 if-branches
  *  32 bit: 5 if-branches
+ *  64 bit: 6 if-branches
  *
  * When roundrobin is enabled, also two shift-, one and-, one or-
  * and one addition operation are needed.
@@ -236,12 +324,20 @@ UVAR_t POSCALL p_pos_findbit(const UVAR_t bitfield, UVAR_t rrOffset)
   UVAR_t bf;
   UVAR_t bit;
   
-  bf = (bitfield << (MVAR_BITS - rrOffset)) | (bitfield >> rrOffset);
+  bf = (bitfield << ((MVAR_BITS - rrOffset) & (MVAR_BITS - 1))) |
+       (bitfield >> rrOffset);
 
 #endif /* POSCFG_ROUNDROBIN */
 
   bit = 0;
 
+#if (MVAR_BITS > 32)
+  if ((bf & 0xFFFFFFFFUL) == 0)
+  {
+    bit |= 32;
+    bf >>= 32;
+  }
+#endif
 #if (MVAR_BITS > 16)
   if ((bf & 0xFFFF) == 0)
   {
@@ -312,7 +408,8 @@ UVAR_t POSCALL p_pos_findbit(const UVAR_t bitfield, UVAR_t rrOffset)
   UVAR_t bf;
   UVAR_t bit;
   
-  bf = (bitfield << (MVAR_BITS - rrOffset)) | (bitfield >> rrOffset);
+  bf = (bitfield << ((MVAR_BITS - rrOffset) & (MVAR_BITS - 1))) |
+       (bitfield >> rrOffset);
 
 #endif /* POSCFG_ROUNDROBIN */
 
@@ -495,7 +592,8 @@ UVAR_t POSCALL p_pos_findbit(const UVAR_t bitfield, UVAR_t rrOffset)
   UVAR_t bf;
   UVAR_t bit;
   
-  bf = (bitfield << (MVAR_BITS - rrOffset)) | (bitfield >> rrOffset);
+  bf = (bitfield << ((MVAR_BITS - rrOffset) & (MVAR_BITS - 1))) |
+       (bitfield >> rrOffset);
   
   for (bit = 0; bit < MVAR_BITS; bit++)
   {
@@ -79,7 +79,10 @@
 
 typedef struct TBITS {
   UVAR_t         xtable[SYS_TASKTABSIZE_Y];
-#if SYS_TASKTABSIZE_Y > 1
+#if SYS_TASKTABSIZE_Z > 1
+  UVAR_t         ymask[SYS_TASKTABSIZE_Z];
+  UVAR_t         zmask;
+#elif SYS_TASKTABSIZE_Y > 1
   UVAR_t         ymask;
 #endif
 } TBITS_t;
@@ -108,6 +111,15 @@ typedef union EVENT {
 #if POSCFG_FEATURE_MUTEXES != 0
     POSTASK_t    task;
 #endif
+#if SYS_MUTEXBOOST != 0
+    union EVENT  *mnext;
+#endif
+#if POSCFG_FEATURE_MUTEXCEILING != 0
+    VAR_t        ceiling;
+#endif
+#if POSCFG_FEATURE_RWLOCKS != 0
+    union EVENT  *writers;
+#endif
 #ifdef POS_DEBUGHELP
     struct PICOEVENT deb;
 #endif
@@ -128,6 +140,69 @@ STATICBUFFER(posStaticEventMem_g, sizeof(union EVENT), \
 
 #if POSCFG_FEATURE_MSGBOXES != 0
 
+#if POSCFG_MSG_SIZECLASSES > 1
+
+/* With size classes the message data follows the buffer header,
+ * so the header is at the same place for all buffer sizes.
+ */
+typedef struct MSGBUF {
+  struct MSGBUF *next;
+#if POSCFG_ARGCHECK > 1
+  UVAR_t         magic;
+#endif
+  UVAR_t         sclass;
+} MSGBUF_t;
+
+#define MSGHDRSIZE          ALIGNEDSIZE(sizeof(MSGBUF_t))
+#define MSGBLOCKSIZE(size)  (MSGHDRSIZE + ALIGNEDSIZE(size))
+#define MSGBUF_DATA(mbuf)   ((void*)(((unsigned char*)(mbuf)) + MSGHDRSIZE))
+#define MSGBUF_HEADER(buf) \
+  ((MSGBUF_t*)(void*)(((unsigned char*)(buf)) - MSGHDRSIZE))
+#define MSGBUF_CLASS(mbuf)  (&posMsgClass_g[(mbuf)->sclass])
+
+#if POSCFG_MSG_SIZECLASSES > 3
+#define MSGCLASS4_MEM  (MSGBLOCKSIZE(POSCFG_MSG_BUFSIZE4)*POSCFG_MAX_MESSAGES4)
+#define MSGCLASS4_CNT  POSCFG_MAX_MESSAGES4
+#else
+#define MSGCLASS4_MEM  0
+#define MSGCLASS4_CNT  0
+#endif
+#if POSCFG_MSG_SIZECLASSES > 2
+#define MSGCLASS3_MEM  (MSGBLOCKSIZE(POSCFG_MSG_BUFSIZE3)*POSCFG_MAX_MESSAGES3)
+#define MSGCLASS3_CNT  POSCFG_MAX_MESSAGES3
+#else
+#define MSGCLASS3_MEM  0
+#define MSGCLASS3_CNT  0
+#endif
+#define MSG_MEMSIZE \
+  ((MSGBLOCKSIZE(POSCFG_MSG_BUFSIZE) * POSCFG_MAX_MESSAGES) + \
+   (MSGBLOCKSIZE(POSCFG_MSG_BUFSIZE2) * POSCFG_MAX_MESSAGES2) + \
+   MSGCLASS3_MEM + MSGCLASS4_MEM)
+#define MSG_COUNT \
+  (POSCFG_MAX_MESSAGES + POSCFG_MAX_MESSAGES2 + MSGCLASS3_CNT + MSGCLASS4_CNT)
+
+static const UINT_t posMsgClassSize_g[POSCFG_MSG_SIZECLASSES] = {
+  POSCFG_MSG_BUFSIZE, POSCFG_MSG_BUFSIZE2
+#if POSCFG_MSG_SIZECLASSES > 2
+  , POSCFG_MSG_BUFSIZE3
+#endif
+#if POSCFG_MSG_SIZECLASSES > 3
+  , POSCFG_MSG_BUFSIZE4
+#endif
+};
+
+static const UINT_t posMsgClassCount_g[POSCFG_MSG_SIZECLASSES] = {
+  POSCFG_MAX_MESSAGES, POSCFG_MAX_MESSAGES2
+#if POSCFG_MSG_SIZECLASSES > 2
+  , POSCFG_MAX_MESSAGES3
+#endif
+#if POSCFG_MSG_SIZECLASSES > 3
+  , POSCFG_MAX_MESSAGES4
+#endif
+};
+
+#else /* POSCFG_MSG_SIZECLASSES */
+
 typedef struct MSGBUF {
 #if POSCFG_MSG_MEMORY != 0
   unsigned char  buffer[POSCFG_MSG_BUFSIZE];
@@ -140,14 +215,30 @@ typedef struct MSGBUF {
   struct MSGBUF *next;
 } MSGBUF_t;
 
-static POSSEMA_t msgAllocSyncSem_g;
-static POSSEMA_t msgAllocWaitSem_g;
-static UVAR_t    msgAllocWaitReq_g;
-static MSGBUF_t  *posFreeMessagebuf_g;
+#define MSGBUF_DATA(mbuf)   ((void*)((mbuf)->buffer))
+#define MSGBUF_HEADER(buf)  ((MSGBUF_t*)(buf))
+#define MSGBUF_CLASS(mbuf)  (&posMsgClass_g[0])
+#define MSG_COUNT           POSCFG_MAX_MESSAGES
+
+#endif /* POSCFG_MSG_SIZECLASSES */
+
+/* pool of message buffers of one size */
+typedef struct MSGCLASS {
+  MSGBUF_t   *freebuf;
+  POSSEMA_t  allocsync;
+  POSSEMA_t  allocwait;
+  UVAR_t     waitreq;
+} MSGCLASS_t;
 
-#if (POSCFG_DYNAMIC_MEMORY == 0) && (POSCFG_MAX_MESSAGES != 0)
+static MSGCLASS_t  posMsgClass_g[POSCFG_MSG_SIZECLASSES];
+
+#if (POSCFG_DYNAMIC_MEMORY == 0) && (MSG_COUNT != 0)
+#if POSCFG_MSG_SIZECLASSES > 1
+STATICBUFFER(posStaticMessageMem_g, MSG_MEMSIZE, 1);
+#else
 STATICBUFFER(posStaticMessageMem_g, sizeof(MSGBUF_t), POSCFG_MAX_MESSAGES);
 #endif
+#endif
 
 #endif /* POSCFG_FEATURE_MSGBOXES */
 
@@ -161,23 +252,56 @@ typedef struct TIMER {
   struct TIMER   *prev;
   struct TIMER   *next;
 #if POSCFG_FEATURE_TIMERCALLBACK != 0
+#if POSCFG_FEATURE_TIMERDAEMON != 0
+#define pos_timerFired(t) pos_timerDefer(t)
+  struct TIMER   *dnext;   /* link in the queue of the timer daemon */
+  UVAR_t         dqueued;
+#else
 #define pos_timerFired(t) t->callback((POSTIMER_t)t, t->callbackArg)
+#endif
   POSTIMERFUNC_t callback;
   void*          callbackArg;
 #else
 #define pos_timerFired(t) posSemaSignal(t->sema)
   POSSEMA_t      sema;
 #endif
-  UINT_t         counter;
+#if POSCFG_TIMER_WHEEL != 0
+  struct TIMER   **slot;   /* wheel slot the timer is linked into */
+#endif
+  UINT_t         counter;  /* timer wheel: absolute expiry wheel time */
   UINT_t         wait;
   UINT_t         reload;
 #if POSCFG_FEATURE_TIMERFIRED != 0
   VAR_t          fired;
 #endif
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  struct TIMER   *hrnext;  /* link in the high resolution list */
+  NSEC_t         hrexpiry; /* absolute deadline */
+  NSEC_t         hrwait;
+  NSEC_t         hrreload;
+  UVAR_t         hires;    /* set by posTimerSetNs */
+#endif
 } TIMER_t;
 
 static TIMER_t   *posFreeTimer_g;
+#if POSCFG_TIMER_WHEEL == 0
 static TIMER_t   *posActiveTimers_g;
+#else
+#define TWHEEL_SIZE          (1 << POSCFG_TIMER_WHEEL_BITS)
+#define TWHEEL_MASK          (TWHEEL_SIZE - 1)
+#define TWHEEL_SHIFT(level)  ((level) * POSCFG_TIMER_WHEEL_BITS)
+static TIMER_t   *posTimerWheel_g[POSCFG_TIMER_WHEEL_LEVELS][TWHEEL_SIZE];
+static UINT_t    posTimerWheelCount_g[POSCFG_TIMER_WHEEL_LEVELS];
+static UINT_t    posTimerWheelNow_g;
+#endif
+#if POSCFG_FEATURE_TIMERDAEMON != 0
+static TIMER_t   *posTimerDaemonHead_g;
+static TIMER_t   *posTimerDaemonTail_g;
+static POSSEMA_t posTimerDaemonSema_g;
+#endif
+#if POSCFG_FEATURE_HIRESTIMER != 0
+static TIMER_t   *posHiresTimers_g;
+#endif
 
 #if (POSCFG_DYNAMIC_MEMORY == 0) && (POSCFG_MAX_TIMER != 0)
 STATICBUFFER(posStaticTmrMem_g, sizeof(TIMER_t), POSCFG_MAX_TIMER);
@@ -200,7 +324,18 @@ static TBITS_t   posReadyTasks_g;
 static TBITS_t   posAllocatedTasks_g;
 static POSTASK_t posSleepingTasks_g;
 static POSTASK_t posFreeTasks_g;
+#if POSCFG_FEATURE_HIRESTIMER != 0
+static POSTASK_t posHiresTasks_g;
+#endif
+#if POSCFG_FEATURE_BUDGET != 0
+static POSTASK_t posThrottledTasks_g;
+#endif
 static POSTASK_t posTaskTable_g[SYS_TASKTABSIZE_X * SYS_TASKTABSIZE_Y];
+#if POSCFG_FEATURE_EDF != 0
+static POSTASK_t posEdfHeap_g[SYS_TASKTABSIZE_X];
+static UVAR_t    posEdfCount_g;
+static UVAR_t    posEdfMask_g;
+#endif
 
 #if POSCFG_CTXSW_COMBINE > 1
 static UVAR_t    posCtxCombineCtr_g;
@@ -227,13 +362,34 @@ STATICBUFFER(posStaticTaskMem_g, sizeof(struct POSTASK), POSCFG_MAX_TASKS);
 
 #if POSCFG_FEATURE_SOFTINTS != 0
 
+#if POSCFG_SOFTINT_COALESCE != 0
+/* one pending bit and one parameter per software interrupt */
+#define SYS_SINTWORDS  ((POSCFG_SOFTINTERRUPTS + MVAR_BITS - 1) / MVAR_BITS)
+static UVAR_t    sintPending_g[SYS_SINTWORDS];
+static UVAR_t    sintParam_g[POSCFG_SOFTINTERRUPTS];
+static POSSINTMERGEFUNC_t sintMerge_g[POSCFG_SOFTINTERRUPTS];
+static UINT_t    sintPendCount_g;
+#else
 static struct {
   UVAR_t         intno;
   UVAR_t         param;
 } softintqueue_g[POSCFG_SOFTINTQUEUELEN + 1];
-static POSINTFUNC_t softIntHandlers_g[POSCFG_SOFTINTERRUPTS];
 static UVAR_t    sintIdxIn_g;
 static UVAR_t    sintIdxOut_g;
+#endif
+static POSINTFUNC_t softIntHandlers_g[POSCFG_SOFTINTERRUPTS];
+#if POSCFG_FEATURE_SOFTINTDEFER != 0
+static struct {
+  POSDEFERFUNC_t func;
+  void           *arg;
+} sintdeferqueue_g[POSCFG_SOFTINTDEFERLEN + 1];
+static UVAR_t    sintDefIdxIn_g;
+static UVAR_t    sintDefIdxOut_g;
+#endif
+#if POSCFG_FEATURE_SOFTINTSTATS != 0
+static UINT_t    sintDropped_g;
+static UINT_t    sintHighWater_g;
+#endif
 
 #endif /* POSCFG_FEATURE_SOFTINTS */
 
@@ -258,11 +414,16 @@ UVAR_t posShift1lTab_g[8] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
 #define POSMAGIC_EVENTU 0x538E
 #define POSMAGIC_MSGBUF 0x7FC4
 #define POSMAGIC_TIMER  0x1455
-#else
+#elif MVAR_BITS == 32
 #define POSMAGIC_TASK   0x4E56A3FC
 #define POSMAGIC_EVENTU 0x538EC75B
 #define POSMAGIC_MSGBUF 0x7FC45AA2
 #define POSMAGIC_TIMER  0x14552384
+#else
+#define POSMAGIC_TASK   0x4E56A3FC91D2E647
+#define POSMAGIC_EVENTU 0x538EC75B2A6F18D3
+#define POSMAGIC_MSGBUF 0x7FC45AA2C3B0795E
+#define POSMAGIC_TIMER  0x1455238467AE0BC1
 #endif
 #define POSMAGIC_EVENTF  (~POSMAGIC_EVENTU)
 
@@ -300,6 +461,28 @@ static UVAR_t  posNextRoundRobin_g[SYS_TASKTABSIZE_Y];
 
 #endif /* ROUNDROBIN */
 
+#if POSCFG_FEATURE_EDF != 0
+
+/* row of the task table that holds the EDF band */
+#define EDF_ROW   ((SYS_TASKTABSIZE_Y - 1) - POSCFG_EDF_PRIO)
+
+/* deadline a is earlier than deadline b, robust against wrap around */
+#define EDF_BEFORE(a, b)  (((SJIF_t)((a) - (b))) < 0)
+
+/* In the EDF row the task with the earliest deadline is selected
+ * (see pos_edfFindTaskX), in all other rows the next task in round
+ * robin order. */
+#define pos_findTaskX(ym) \
+    (((ym) == EDF_ROW) ? pos_edfFindTaskX() : \
+      POS_FINDBIT_EX(posReadyTasks_g.xtable[ym], POS_NEXTROUNDROBIN(ym)))
+
+#else
+
+#define pos_findTaskX(ym) \
+    POS_FINDBIT_EX(posReadyTasks_g.xtable[ym], POS_NEXTROUNDROBIN(ym))
+
+#endif /* POSCFG_FEATURE_EDF */
+
 
 
 /*---------------------------------------------------------------------------
@@ -311,8 +494,8 @@ static void              pos_idletask(void *arg);
 #if SYS_FEATURE_EVENTS != 0
 static VAR_t POSCALL     pos_sched_event(EVENT_t ev);
 #endif
-#if (POSCFG_FEATURE_MSGBOXES != 0) && (POSCFG_MSG_MEMORY == 0)
-static MSGBUF_t* POSCALL pos_msgAlloc(void);
+#if POSCFG_FEATURE_MSGBOXES != 0
+static MSGBUF_t* POSCALL pos_msgAlloc(UVAR_t sclass);
 static void  POSCALL     pos_msgFree(MSGBUF_t *mbuf);
 #endif
 #if POSCFG_FEATURE_SOFTINTS != 0
@@ -325,6 +508,9 @@ static void  POSCALL     pos_listJoin(POSLIST_t *prev, POSLIST_t *next,
 #endif
 static void  POSCALL     pos_listRemove(POSLIST_t *listelem);
 #endif
+#if (POSCFG_FEATURE_TIMER != 0) && (POSCFG_FEATURE_TIMERCALLBACK != 0)
+static void              pos_timerSemaSignal(POSTIMER_t timer, void* sema);
+#endif
 
 
 
@@ -358,7 +544,36 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
 #endif
 
 
-#if SYS_TASKTABSIZE_Y > 1
+#if SYS_TASKTABSIZE_Z > 1
+
+#define pos_idxZ(y)   ((y) / MVAR_BITS)
+
+#define pos_setTableBit(table, task) do { \
+    (table)->zmask |= (task)->bit_z; \
+    (table)->ymask[pos_idxZ((task)->idx_y)] |= (task)->bit_y; \
+    (table)->xtable[(task)->idx_y] |= (task)->bit_x; } while(0)
+
+#define pos_delTableBit(table, task) do { \
+    UVAR_t tbt; \
+    tbt  = (table)->xtable[(task)->idx_y] & ~(task)->bit_x; \
+    (table)->xtable[(task)->idx_y] = tbt; \
+    if (tbt == 0) { \
+      tbt = (table)->ymask[pos_idxZ((task)->idx_y)] & ~(task)->bit_y; \
+      (table)->ymask[pos_idxZ((task)->idx_y)] = tbt; \
+      if (tbt == 0) (table)->zmask &= ~(task)->bit_z; } } while(0)
+
+#define pos_isTableBitSet(table, task) \
+    (((table)->xtable[(task)->idx_y] & (task)->bit_x) != 0)
+
+#define pos_setTaskIdxY(task, y) do { \
+    (task)->idx_y = (y); \
+    (task)->bit_y = pos_shift1l((y) & (MVAR_BITS - 1)); \
+    (task)->bit_z = pos_shift1l(pos_idxZ(y)); } while(0)
+
+#define pos_tableEmpty(table)   ((table)->zmask == 0)
+#define pos_findTableY(table)   pos_findTableY3(table)
+
+#elif SYS_TASKTABSIZE_Y > 1
 
 #define pos_setTableBit(table, task) do { \
     (table)->ymask |= (task)->bit_y; \
@@ -373,6 +588,13 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
 #define pos_isTableBitSet(table, task) \
     (((table)->xtable[(task)->idx_y] & (task)->bit_x) != 0)
 
+#define pos_setTaskIdxY(task, y) do { \
+    (task)->idx_y = (y); \
+    (task)->bit_y = pos_shift1l(y); } while(0)
+
+#define pos_tableEmpty(table)   ((table)->ymask == 0)
+#define pos_findTableY(table)   POS_FINDBIT((table)->ymask)
+
 #else
 
 #define pos_setTableBit(table, task) do { \
@@ -384,6 +606,11 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
 #define pos_isTableBitSet(table, task) \
     (((table)->xtable[0] & (task)->bit_x) != 0)
 
+#define pos_setTaskIdxY(task, y)  do { } while(0)
+
+#define pos_tableEmpty(table)   ((table)->xtable[0] == 0)
+#define pos_findTableY(table)   0
+
 #endif
 
 #define pos_addToList(list, elem) do { \
@@ -398,7 +625,17 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
     else list = (elem)->next; } while(0)
 
 #if POSCFG_FEATURE_SOFTINTS != 0
-#define softIntsPending()  (sintIdxIn_g != sintIdxOut_g)
+#if POSCFG_SOFTINT_COALESCE != 0
+#define sintQueuePending()  (sintPendCount_g != 0)
+#else
+#define sintQueuePending()  (sintIdxIn_g != sintIdxOut_g)
+#endif
+#if POSCFG_FEATURE_SOFTINTDEFER != 0
+#define softIntsPending()  \
+  (sintQueuePending() || (sintDefIdxIn_g != sintDefIdxOut_g))
+#else
+#define softIntsPending()  sintQueuePending()
+#endif
 #define pos_doSoftInts() \
   if (softIntsPending())  pos_execSoftIntQueue();
 #else
@@ -425,13 +662,6 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
  * some HELPER FUNCTIONS  (can be inlined)
  *-------------------------------------------------------------------------*/
 
-#if SYS_TASKDOUBLELINK == 0
-#define pos_addToSleepList(task) do { \
-    (task)->next = posSleepingTasks_g; \
-    posSleepingTasks_g = task; } while(0)
-#endif
-
-
 #if SYS_FEATURE_EVENTS != 0
 #if ((POSCFG_FASTCODE==0)||defined(POS_DEBUGHELP)||(SYS_TASKEVENTLINK!=0)) \
     && (SYS_EVENTS_USED!=0)
@@ -468,25 +698,119 @@ static void POSCALL pos_eventRemoveTask(EVENT_t ev, POSTASK_t task)
 #endif  /* SYS_FEATURE_EVENTS */
 
 
-#if POSCFG_FASTCODE != 0
+#if POSCFG_FEATURE_EDF != 0
 
-#define pos_enableTask(task)    pos_setTableBit(&posReadyTasks_g, task)
-#define pos_disableTask(task)   pos_delTableBit(&posReadyTasks_g, task)
+/* The ready EDF tasks are kept in a binary min-heap, ordered by their
+ * absolute deadline. task->edfidx is the heap position plus one,
+ * 0 means the task is not in the heap.
+ */
+static void POSCALL pos_edfSiftUp(UVAR_t i, POSTASK_t task);
+static void POSCALL pos_edfSiftUp(UVAR_t i, POSTASK_t task)
+{
+  register POSTASK_t parent;
 
-#if SYS_TASKDOUBLELINK != 0
-#define pos_addToSleepList(task) \
-          pos_addToList(posSleepingTasks_g, task)
-#define pos_removeFromSleepList(task) \
-          pos_removeFromList(posSleepingTasks_g, task)
-#endif  /* SYS_TASKDOUBLELINK */
+  while (i != 0)
+  {
+    parent = posEdfHeap_g[(i - 1) / 2];
+    if (!EDF_BEFORE(task->edfdeadline, parent->edfdeadline))
+      break;
+    posEdfHeap_g[i] = parent;
+    parent->edfidx = i + 1;
+    i = (i - 1) / 2;
+  }
+  posEdfHeap_g[i] = task;
+  task->edfidx = i + 1;
+}
 
-#if POSCFG_FEATURE_TIMER != 0
-#define pos_addToTimerList(timer) \
-          pos_addToList(posActiveTimers_g, timer)
-#define pos_removeFromTimerList(timer) do { \
-          pos_removeFromList(posActiveTimers_g, timer); \
-          timer->prev = timer; } while (0)
-#endif  /* POSCFG_FEATURE_TIMER */
+static void POSCALL pos_edfSiftDown(UVAR_t i, POSTASK_t task);
+static void POSCALL pos_edfSiftDown(UVAR_t i, POSTASK_t task)
+{
+  register POSTASK_t child;
+  register UVAR_t c;
+
+  for (;;)
+  {
+    c = (2 * i) + 1;
+    if (c >= posEdfCount_g)
+      break;
+    child = posEdfHeap_g[c];
+    if ((c + 1 < posEdfCount_g) &&
+        EDF_BEFORE(posEdfHeap_g[c + 1]->edfdeadline, child->edfdeadline))
+    {
+      child = posEdfHeap_g[++c];
+    }
+    if (!EDF_BEFORE(child->edfdeadline, task->edfdeadline))
+      break;
+    posEdfHeap_g[i] = child;
+    child->edfidx = i + 1;
+    i = c;
+  }
+  posEdfHeap_g[i] = task;
+  task->edfidx = i + 1;
+}
+
+/* Add a ready EDF task to the heap. Tasks outside the EDF row (for
+ * example a task raised by a mutex) and normal tasks are ignored.
+ */
+static void POSCALL pos_edfInsert(POSTASK_t task);
+static void POSCALL pos_edfInsert(POSTASK_t task)
+{
+  if ((task->edfperiod != 0) && (task->edfidx == 0) &&
+      (task->idx_y == EDF_ROW))
+  {
+    pos_edfSiftUp(posEdfCount_g++, task);
+    posEdfMask_g |= task->bit_x;
+  }
+}
+
+static void POSCALL pos_edfRemove(POSTASK_t task);
+static void POSCALL pos_edfRemove(POSTASK_t task)
+{
+  register POSTASK_t last;
+  register UVAR_t i;
+
+  if (task->edfidx == 0)
+    return;
+  posEdfMask_g &= ~task->bit_x;
+  i = task->edfidx - 1;
+  task->edfidx = 0;
+  last = posEdfHeap_g[--posEdfCount_g];
+  if (last == task)
+    return;
+  if ((i != 0) &&
+      EDF_BEFORE(last->edfdeadline, posEdfHeap_g[(i - 1) / 2]->edfdeadline))
+  {
+    pos_edfSiftUp(i, last);
+  }
+  else
+  {
+    pos_edfSiftDown(i, last);
+  }
+}
+
+/* Select the task to run in the EDF row. A normal task is there only
+ * while a mutex raises its priority, so it may hold a mutex an EDF task
+ * waits for. Such tasks run first, then the EDF task with the earliest
+ * deadline.
+ */
+static UVAR_t POSCALL pos_edfFindTaskX(void);
+static UVAR_t POSCALL pos_edfFindTaskX(void)
+{
+  register UVAR_t raised;
+
+  raised = posReadyTasks_g.xtable[EDF_ROW] & ~posEdfMask_g;
+  if (raised != 0)
+    return POS_FINDBIT_EX(raised, POS_NEXTROUNDROBIN(EDF_ROW));
+  return POS_FINDBIT(posEdfHeap_g[0]->bit_x);
+}
+
+#endif  /* POSCFG_FEATURE_EDF */
+
+
+#if (POSCFG_FASTCODE != 0) && (POSCFG_FEATURE_EDF == 0)
+
+#define pos_enableTask(task)    pos_setTableBit(&posReadyTasks_g, task)
+#define pos_disableTask(task)   pos_delTableBit(&posReadyTasks_g, task)
 
 #else /* POSCFG_FASTCODE */
 
@@ -494,98 +818,598 @@ static void POSCALL pos_disableTask(POSTASK_t task);
 static void POSCALL pos_disableTask(POSTASK_t task)
 {
   pos_delTableBit(&posReadyTasks_g, task);
+#if POSCFG_FEATURE_EDF != 0
+  pos_edfRemove(task);
+#endif
 }
 
 static void POSCALL pos_enableTask(POSTASK_t task);
 static void POSCALL pos_enableTask(POSTASK_t task)
 {
   pos_setTableBit(&posReadyTasks_g, task);
+#if POSCFG_FEATURE_EDF != 0
+  pos_edfInsert(task);
+#endif
 }
 
-#if SYS_TASKDOUBLELINK != 0
+#endif  /* POSCFG_FASTCODE */
+
+
+#if SYS_TASKTABSIZE_Z > 1
+
+/* Three level table: The z-mask selects a group of MVAR_BITS rows,
+ * the y-mask of the group the row. Returns the first row with a bit set.
+ */
+static UVAR_t POSCALL pos_findTableY3(TBITS_t *table);
+static UVAR_t POSCALL pos_findTableY3(TBITS_t *table)
+{
+  register UVAR_t z = POS_FINDBIT(table->zmask);
+  return (z * MVAR_BITS) + POS_FINDBIT(table->ymask[z]);
+}
+
+#if (POSCFG_FEATURE_YIELD != 0) && (POSCFG_ROUNDROBIN != 0)
+/* Returns the first row after row y with a bit set.
+ * There must be such a row (the idle task is always ready).
+ */
+static UVAR_t POSCALL pos_findTableNextY3(TBITS_t *table, UVAR_t y);
+static UVAR_t POSCALL pos_findTableNextY3(TBITS_t *table, UVAR_t y)
+{
+  register UVAR_t z, m;
+
+  z = pos_idxZ(y);
+  if ((y & (MVAR_BITS - 1)) != (MVAR_BITS - 1))
+  {
+    m = table->ymask[z] & pos_zmask(y & (MVAR_BITS - 1));
+    if (m != 0)
+      return (z * MVAR_BITS) + POS_FINDBIT(m);
+  }
+  z = POS_FINDBIT(table->zmask & pos_zmask(z));
+  return (z * MVAR_BITS) + POS_FINDBIT(table->ymask[z]);
+}
+#endif
+
+#endif  /* SYS_TASKTABSIZE_Z */
+
+
+/* The sleep list is a delta queue: It is sorted by wakeup time, and the
+ * timer ticks of a task are relative to the ticks of its predecessor.
+ * The timer interrupt needs only to look at the head of the list.
+ */
 static void POSCALL pos_addToSleepList(POSTASK_t task);
 static void POSCALL pos_addToSleepList(POSTASK_t task)
 {
-  pos_addToList(posSleepingTasks_g, task);
+  register POSTASK_t  next = posSleepingTasks_g;
+  register POSTASK_t  last = NULL;
+
+  while ((next != NULL) && (tasktimerticks(next) <= tasktimerticks(task)))
+  {
+    tasktimerticks(task) -= tasktimerticks(next);
+    last = next;
+    next = next->next;
+  }
+  if (next != NULL)
+  {
+    tasktimerticks(next) -= tasktimerticks(task);
+#if SYS_TASKDOUBLELINK != 0
+    next->prev = task;
+#endif
+  }
+  task->next = next;
+#if SYS_TASKDOUBLELINK != 0
+  task->prev = last;
+#endif
+  if (last == NULL)
+  {
+    posSleepingTasks_g = task;
+  }
+  else
+  {
+    last->next = task;
+  }
 }
 
+#if SYS_TASKDOUBLELINK != 0
 static void POSCALL pos_removeFromSleepList(POSTASK_t task);
 static void POSCALL pos_removeFromSleepList(POSTASK_t task)
 {
+  if (task->next != NULL)
+    tasktimerticks(task->next) += tasktimerticks(task);
   pos_removeFromList(posSleepingTasks_g, task);
 }
 #endif  /* SYS_TASKDOUBLELINK */
 
-#if POSCFG_FEATURE_TIMER != 0
+
+#if (POSCFG_FEATURE_TIMER != 0) && (POSCFG_TIMER_WHEEL == 0)
+
+/* Like the sleep list, the list of active timers is a delta queue.
+ * timer->counter holds the ticks relative to the previous timer.
+ */
 static void POSCALL pos_addToTimerList(TIMER_t *timer);
 static void POSCALL pos_addToTimerList(TIMER_t *timer)
 {
-  pos_addToList(posActiveTimers_g, timer);
+  register TIMER_t  *next = posActiveTimers_g;
+  register TIMER_t  *last = NULL;
+
+  /* A counter of zero would wrap with the next tick and stall all
+   * timers behind it. Such a timer expires with the next tick. */
+  if (timer->counter == 0)
+    timer->counter = 1;
+  while ((next != NULL) && (next->counter <= timer->counter))
+  {
+    timer->counter -= next->counter;
+    last = next;
+    next = next->next;
+  }
+  if (next != NULL)
+  {
+    next->counter -= timer->counter;
+    next->prev = timer;
+  }
+  timer->next = next;
+  timer->prev = last;
+  if (last == NULL)
+  {
+    posActiveTimers_g = timer;
+  }
+  else
+  {
+    last->next = timer;
+  }
 }
 
 static void POSCALL pos_removeFromTimerList(TIMER_t *timer);
 static void POSCALL pos_removeFromTimerList(TIMER_t *timer)
 {
+  if (timer->next != NULL)
+    timer->next->counter += timer->counter;
   pos_removeFromList(posActiveTimers_g, timer);
   timer->prev = timer;
 }
+
 #endif  /* POSCFG_FEATURE_TIMER */
 
-#endif  /* POSCFG_FASTCODE */
 
+#if (POSCFG_FEATURE_TIMER != 0) && (POSCFG_TIMER_WHEEL != 0)
 
+/* Link a timer into the wheel. timer->counter must hold the absolute
+ * expiry time. The timer is put into the lowest wheel level that covers
+ * its remaining time. Timers that expire beyond the range of the wheel
+ * are parked in the last slot of the highest level and are re-sorted
+ * when that slot is cascaded.
+ */
+static void POSCALL pos_timerWheelInsert(TIMER_t *timer);
+static void POSCALL pos_timerWheelInsert(TIMER_t *timer)
+{
+  register UINT_t  delta = timer->counter - posTimerWheelNow_g;
+  register UINT_t  idx;
+  register UVAR_t  level = 0;
 
-/*---------------------------------------------------------------------------
- * PRIVATE FUNCTIONS
- *-------------------------------------------------------------------------*/
+  while ((level < POSCFG_TIMER_WHEEL_LEVELS - 1) &&
+         ((delta >> TWHEEL_SHIFT(level + 1)) != 0))
+  {
+    ++level;
+  }
+  if ((delta >> TWHEEL_SHIFT(level)) > TWHEEL_MASK)
+  {
+    idx = (posTimerWheelNow_g >> TWHEEL_SHIFT(level)) + TWHEEL_MASK;
+  }
+  else
+  {
+    idx = timer->counter >> TWHEEL_SHIFT(level);
+  }
+  idx &= TWHEEL_MASK;
+  pos_addToList(posTimerWheel_g[level][idx], timer);
+  timer->slot = &posTimerWheel_g[level][idx];
+  ++posTimerWheelCount_g[level];
+}
 
-#ifdef POS_DEBUGHELP
-void POSCALL posdeb_setEventName(void *event, const char *name)
+static void POSCALL pos_addToTimerList(TIMER_t *timer);
+static void POSCALL pos_addToTimerList(TIMER_t *timer)
 {
-  EVENT_t ev = (EVENT_t) event;
-  if (ev != NULL) ev->e.deb.name = name;
+  /* A delta of zero would put the timer into the slot the wheel has
+   * already passed, it would fire only a full revolution later.
+   * Such a timer expires with the next tick. */
+  if (timer->counter == 0)
+    timer->counter = 1;
+  timer->counter += posTimerWheelNow_g;
+  pos_timerWheelInsert(timer);
 }
-#endif
 
-#if POSCFG_FEATURE_LISTS != 0
-#if POSCFG_FEATURE_LISTJOIN != 0
-static void POSCALL pos_listJoin(POSLIST_t *prev, POSLIST_t *next,
-                                 POSLIST_t *newlist)
+static void POSCALL pos_removeFromTimerList(TIMER_t *timer);
+static void POSCALL pos_removeFromTimerList(TIMER_t *timer)
 {
-  next->prev          = newlist->prev;
-  newlist->prev->next = next;
-  newlist->prev       = prev;
-  prev->next          = newlist;
+  --posTimerWheelCount_g[(timer->slot - &posTimerWheel_g[0][0]) >>
+                         POSCFG_TIMER_WHEEL_BITS];
+  pos_removeFromList((*timer->slot), timer);
+  timer->prev = timer;
 }
-#endif
 
-static void POSCALL pos_listRemove(POSLIST_t *listelem)
+#endif  /* POSCFG_TIMER_WHEEL */
+
+
+#if POSCFG_FEATURE_TIMERDAEMON != 0
+
+/* Hand an expired callback timer over to the timer daemon task.
+ * Timers that only signal a semaphore, and all timers while no
+ * daemon runs, are still served directly from the timer interrupt.
+ */
+static void POSCALL pos_timerDefer(TIMER_t *tmr);
+static void POSCALL pos_timerDefer(TIMER_t *tmr)
 {
-  register POSLIST_t *prev, *next;
-  prev = listelem->prev;
-  next = listelem->next;  
-  next->prev = prev;
-  prev->next = next;
-#ifdef _DBG
-#if POSCFG_FEATURE_LISTLEN != 0
-  listelem->head = NULL;
-#endif
-#endif
+  if ((posTimerDaemonSema_g == NULL) ||
+      (tmr->callback == pos_timerSemaSignal))
+  {
+    tmr->callback((POSTIMER_t) tmr, tmr->callbackArg);
+    return;
+  }
+  if (tmr->dqueued != 0)
+    return;  /* the callback of the last expiry did not run yet */
+  tmr->dqueued = 1;
+  tmr->dnext = NULL;
+  if (posTimerDaemonHead_g == NULL)
+  {
+    posTimerDaemonHead_g = tmr;
+    posSemaSignal(posTimerDaemonSema_g);
+  }
+  else
+  {
+    posTimerDaemonTail_g->dnext = tmr;
+  }
+  posTimerDaemonTail_g = tmr;
 }
-#endif /* POSCFG_FEATURE_LISTS */
 
-static void pos_idletask(void *arg)
+/* Take a timer out of the queue of the timer daemon.
+ * Must be called with the scheduler locked.
+ */
+static void POSCALL pos_timerUnqueue(TIMER_t *tmr);
+static void POSCALL pos_timerUnqueue(TIMER_t *tmr)
 {
-  POS_LOCKFLAGS;
-
-  (void) arg;
+  register TIMER_t *t, *prev = NULL;
 
-  for(;;)
+  for (t = posTimerDaemonHead_g; t != NULL; prev = t, t = t->dnext)
   {
-#if POSCFG_FEATURE_INHIBITSCHED != 0
-    P_ASSERT("pos_idletask: schedule allowed", posInhibitSched_g == 0);
-#endif
-    POS_SCHED_LOCK;
+    if (t == tmr)
+    {
+      if (prev == NULL)
+        posTimerDaemonHead_g = t->dnext;
+      else
+        prev->dnext = t->dnext;
+      if (posTimerDaemonTail_g == t)
+        posTimerDaemonTail_g = prev;
+      break;
+    }
+  }
+  tmr->dqueued = 0;
+}
+
+#endif  /* POSCFG_FEATURE_TIMERDAEMON */
+
+#if POSCFG_FEATURE_TIMER != 0
+
+/* Unlink an expired timer and fire it. Periodic timers are
+ * linked in again, unless the callback has restarted the timer.
+ */
+static void POSCALL pos_timerExpired(TIMER_t *tmr);
+static void POSCALL pos_timerExpired(TIMER_t *tmr)
+{
+  pos_removeFromTimerList(tmr);
+  pos_timerFired(tmr);
+#if POSCFG_FEATURE_TIMERFIRED != 0
+  tmr->fired = 1;
+#endif
+  if ((tmr->reload != 0) && (tmr->prev == tmr))
+  {
+    tmr->counter = tmr->reload;
+    pos_addToTimerList(tmr);
+  }
+}
+
+#endif  /* POSCFG_FEATURE_TIMER */
+
+
+#if POSCFG_FEATURE_HIRESTIMER != 0
+
+/* The high resolution lists of tasks and timers are sorted by their
+ * absolute deadline in nanoseconds, the compare of the port is set to
+ * the earlier one of both list heads. An element that is not linked
+ * into a list points to itself.
+ */
+#define NSEC_BEFORE(a, b) \
+  ((NSEC_t)((a) - (b)) > ((NSEC_t) ~((NSEC_t) 0) >> 1))
+
+static void POSCALL pos_hiresProgram(void);
+static void POSCALL pos_hiresProgram(void)
+{
+  register UVAR_t  set = 0;
+  NSEC_t           deadline = 0;
+
+  if (posHiresTasks_g != NULL)
+  {
+    deadline = posHiresTasks_g->hrexpiry;
+    set = 1;
+  }
+#if POSCFG_FEATURE_TIMER != 0
+  if ((posHiresTimers_g != NULL) &&
+      (!set || NSEC_BEFORE(posHiresTimers_g->hrexpiry, deadline)))
+  {
+    deadline = posHiresTimers_g->hrexpiry;
+    set = 1;
+  }
+#endif
+  if (set)
+    p_pos_hiresSetCompare(deadline);
+}
+
+static void POSCALL pos_hiresAddTask(POSTASK_t task);
+static void POSCALL pos_hiresAddTask(POSTASK_t task)
+{
+  register POSTASK_t  *link = &posHiresTasks_g;
+
+  while ((*link != NULL) && !NSEC_BEFORE(task->hrexpiry, (*link)->hrexpiry))
+    link = &(*link)->hrnext;
+  task->hrnext = *link;
+  *link = task;
+  if (posHiresTasks_g == task)
+    pos_hiresProgram();
+}
+
+static void POSCALL pos_hiresRemoveTask(POSTASK_t task);
+static void POSCALL pos_hiresRemoveTask(POSTASK_t task)
+{
+  register POSTASK_t  *link;
+
+  for (link = &posHiresTasks_g; *link != NULL; link = &(*link)->hrnext)
+  {
+    if (*link == task)
+    {
+      *link = task->hrnext;
+      break;
+    }
+  }
+  task->hrnext = task;
+}
+
+#if POSCFG_FEATURE_TIMER != 0
+
+static void POSCALL pos_hiresAddTimer(TIMER_t *tmr);
+static void POSCALL pos_hiresAddTimer(TIMER_t *tmr)
+{
+  register TIMER_t  **link = &posHiresTimers_g;
+
+  while ((*link != NULL) && !NSEC_BEFORE(tmr->hrexpiry, (*link)->hrexpiry))
+    link = &(*link)->hrnext;
+  tmr->hrnext = *link;
+  *link = tmr;
+}
+
+static void POSCALL pos_hiresRemoveTimer(TIMER_t *tmr);
+static void POSCALL pos_hiresRemoveTimer(TIMER_t *tmr)
+{
+  register TIMER_t  **link;
+
+  for (link = &posHiresTimers_g; *link != NULL; link = &(*link)->hrnext)
+  {
+    if (*link == tmr)
+    {
+      *link = tmr->hrnext;
+      break;
+    }
+  }
+  tmr->hrnext = tmr;
+}
+
+/* Fire the timer at the head of the high resolution list. A periodic
+ * timer keeps its phase, periods that were missed are skipped.
+ */
+static void POSCALL pos_hiresTimerExpired(TIMER_t *tmr, NSEC_t now);
+static void POSCALL pos_hiresTimerExpired(TIMER_t *tmr, NSEC_t now)
+{
+  posHiresTimers_g = tmr->hrnext;
+  tmr->hrnext = tmr;
+  pos_timerFired(tmr);
+#if POSCFG_FEATURE_TIMERFIRED != 0
+  tmr->fired = 1;
+#endif
+  if ((tmr->hrreload != 0) && (tmr->hrnext == tmr))
+  {
+    tmr->hrexpiry += tmr->hrreload;
+    if (!NSEC_BEFORE(now, tmr->hrexpiry))
+      tmr->hrexpiry += ((now - tmr->hrexpiry) / tmr->hrreload + 1) *
+                       tmr->hrreload;
+    pos_hiresAddTimer(tmr);
+  }
+}
+
+#endif  /* POSCFG_FEATURE_TIMER */
+#endif  /* POSCFG_FEATURE_HIRESTIMER */
+
+
+#if (POSCFG_FEATURE_TIMER != 0) && (POSCFG_TIMER_WHEEL != 0)
+
+/* Advance the wheel by one tick: cascade the timers of the higher levels
+ * down if a lower level has wrapped around, then fire all timers in the
+ * current slot of the lowest level (they all expire now).
+ */
+static void POSCALL pos_timerWheelTick(void);
+static void POSCALL pos_timerWheelTick(void)
+{
+  register TIMER_t  *tmr;
+  register UINT_t   now;
+  register UVAR_t   level;
+  TIMER_t           **slot;
+
+  now = ++posTimerWheelNow_g;
+
+  for (level = 1; (level < POSCFG_TIMER_WHEEL_LEVELS) &&
+       (((now >> TWHEEL_SHIFT(level - 1)) & TWHEEL_MASK) == 0); ++level)
+  {
+    slot = &posTimerWheel_g[level][(now >> TWHEEL_SHIFT(level)) & TWHEEL_MASK];
+    while ((tmr = *slot) != NULL)
+    {
+      pos_removeFromTimerList(tmr);
+      pos_timerWheelInsert(tmr);
+    }
+  }
+
+  slot = &posTimerWheel_g[0][now & TWHEEL_MASK];
+  while ((tmr = *slot) != NULL)
+  {
+    pos_timerExpired(tmr);
+  }
+}
+
+#if POSCFG_FEATURE_TICKLESS != 0
+
+/* Advance the wheel by a number of ticks. Ranges of time where nothing
+ * can expire or cascade are skipped in one step.
+ */
+static void POSCALL pos_timerWheelAdvance(UVAR_t ticks);
+static void POSCALL pos_timerWheelAdvance(UVAR_t ticks)
+{
+  register UINT_t  now;
+  register UINT_t  dist;
+  register UVAR_t  level;
+
+  while (ticks != 0)
+  {
+    for (level = 0; (level < POSCFG_TIMER_WHEEL_LEVELS) &&
+         (posTimerWheelCount_g[level] == 0); ++level);
+
+    if (level == POSCFG_TIMER_WHEEL_LEVELS)
+    {
+      posTimerWheelNow_g += ticks;
+      break;
+    }
+
+    now = posTimerWheelNow_g;
+    if (level == 0)
+    {
+      dist = 1;
+      while ((((now + dist) & TWHEEL_MASK) != 0) &&
+             (posTimerWheel_g[0][(now + dist) & TWHEEL_MASK] == NULL))
+      {
+        ++dist;
+      }
+    }
+    else
+    {
+      dist = (((now >> TWHEEL_SHIFT(level)) + 1) << TWHEEL_SHIFT(level))
+             - now;
+    }
+
+    if (dist > ticks)
+    {
+      posTimerWheelNow_g += ticks;
+      break;
+    }
+    posTimerWheelNow_g += dist - 1;
+    ticks -= (UVAR_t) dist;
+    pos_timerWheelTick();
+  }
+}
+
+/* Return the ticks until the next wheel event. This is either the
+ * expiry of a timer in the lowest level or the cascade of a non-empty
+ * slot in a higher level (which may wake the system a bit early).
+ * The costs are bounded by the wheel size, not by the count of timers.
+ */
+static UINT_t POSCALL pos_timerWheelNext(void);
+static UINT_t POSCALL pos_timerWheelNext(void)
+{
+  register UINT_t  now = posTimerWheelNow_g;
+  register UINT_t  wake = INFINITE;
+  register UINT_t  base;
+  register UINT_t  d;
+  register UVAR_t  level;
+
+  if (posTimerWheelCount_g[0] != 0)
+  {
+    for (d = 1; d < TWHEEL_SIZE; ++d)
+    {
+      if (posTimerWheel_g[0][(now + d) & TWHEEL_MASK] != NULL)
+      {
+        wake = d;
+        break;
+      }
+    }
+  }
+
+  for (level = 1; level < POSCFG_TIMER_WHEEL_LEVELS; ++level)
+  {
+    if (posTimerWheelCount_g[level] == 0)
+      continue;
+
+    base = now >> TWHEEL_SHIFT(level);
+    for (d = 1; d <= TWHEEL_SIZE; ++d)
+    {
+      if (posTimerWheel_g[level][(base + d) & TWHEEL_MASK] != NULL)
+      {
+        d = ((base + d) << TWHEEL_SHIFT(level)) - now;
+        if (wake == INFINITE || d < wake)
+          wake = d;
+        break;
+      }
+    }
+  }
+  return wake;
+}
+
+#endif  /* POSCFG_FEATURE_TICKLESS */
+#endif  /* POSCFG_TIMER_WHEEL */
+
+
+
+/*---------------------------------------------------------------------------
+ * PRIVATE FUNCTIONS
+ *-------------------------------------------------------------------------*/
+
+#ifdef POS_DEBUGHELP
+void POSCALL posdeb_setEventName(void *event, const char *name)
+{
+  EVENT_t ev = (EVENT_t) event;
+  if (ev != NULL) ev->e.deb.name = name;
+}
+#endif
+
+#if POSCFG_FEATURE_LISTS != 0
+#if POSCFG_FEATURE_LISTJOIN != 0
+static void POSCALL pos_listJoin(POSLIST_t *prev, POSLIST_t *next,
+                                 POSLIST_t *newlist)
+{
+  next->prev          = newlist->prev;
+  newlist->prev->next = next;
+  newlist->prev       = prev;
+  prev->next          = newlist;
+}
+#endif
+
+static void POSCALL pos_listRemove(POSLIST_t *listelem)
+{
+  register POSLIST_t *prev, *next;
+  prev = listelem->prev;
+  next = listelem->next;  
+  next->prev = prev;
+  prev->next = next;
+#ifdef _DBG
+#if POSCFG_FEATURE_LISTLEN != 0
+  listelem->head = NULL;
+#endif
+#endif
+}
+#endif /* POSCFG_FEATURE_LISTS */
+
+static void pos_idletask(void *arg)
+{
+  POS_LOCKFLAGS;
+
+  (void) arg;
+
+  for(;;)
+  {
+#if POSCFG_FEATURE_INHIBITSCHED != 0
+    P_ASSERT("pos_idletask: schedule allowed", posInhibitSched_g == 0);
+#endif
+    POS_SCHED_LOCK;
 #ifdef POS_DEBUGHELP
     posCurrentTask_g->deb.state = task_suspended;
 #endif
@@ -627,6 +1451,14 @@ static void pos_idletask(void *arg)
 static void POSCALL pos_execSoftIntQueue(void)
 {
   register UVAR_t intno;
+#if POSCFG_SOFTINT_COALESCE != 0
+  register UVAR_t w, b;
+  UVAR_t param;
+#endif
+#if POSCFG_FEATURE_SOFTINTDEFER != 0
+  POSDEFERFUNC_t dfunc;
+  void *darg;
+#endif
 #ifdef POS_DEBUGHELP
   enum PTASKSTATE sst = posCurrentTask_g->deb.state;
 #endif
@@ -637,21 +1469,65 @@ static void POSCALL pos_execSoftIntQueue(void)
   ++posInInterrupt_g;
   do
   {
-    intno = softintqueue_g[sintIdxOut_g].intno;
-    if (softIntHandlers_g[intno] != NULL)
+#if POSCFG_SOFTINT_COALESCE != 0
+    /* lower interrupt numbers are served first */
+    for (w = 0; w < SYS_SINTWORDS; ++w)
+    {
+      while (sintPending_g[w] != 0)
+      {
+        b = POS_FINDBIT(sintPending_g[w]);
+        sintPending_g[w] &= ~pos_shift1l(b);
+        --sintPendCount_g;
+        intno = (UVAR_t) ((w * MVAR_BITS) + b);
+        param = sintParam_g[intno];
+        if (softIntHandlers_g[intno] != NULL)
+        {
+#ifdef HAVE_IRQ_DISABLE_ALL
+          POS_IRQ_ENABLE_ALL;
+#endif
+          (softIntHandlers_g[intno])(param);
+#ifdef HAVE_IRQ_DISABLE_ALL
+          POS_IRQ_DISABLE_ALL;
+#endif
+        }
+      }
+    }
+#else
+    while (sintIdxIn_g != sintIdxOut_g)
+    {
+      intno = softintqueue_g[sintIdxOut_g].intno;
+      if (softIntHandlers_g[intno] != NULL)
+      {
+#ifdef HAVE_IRQ_DISABLE_ALL
+        POS_IRQ_ENABLE_ALL;
+#endif
+        (softIntHandlers_g[intno])(softintqueue_g[sintIdxOut_g].param);
+#ifdef HAVE_IRQ_DISABLE_ALL
+        POS_IRQ_DISABLE_ALL;
+#endif
+      }
+      if (++sintIdxOut_g > POSCFG_SOFTINTQUEUELEN)
+        sintIdxOut_g = 0;
+    }
+#endif
+#if POSCFG_FEATURE_SOFTINTDEFER != 0
+    while (sintDefIdxIn_g != sintDefIdxOut_g)
     {
+      dfunc = sintdeferqueue_g[sintDefIdxOut_g].func;
+      darg  = sintdeferqueue_g[sintDefIdxOut_g].arg;
+      if (++sintDefIdxOut_g > POSCFG_SOFTINTDEFERLEN)
+        sintDefIdxOut_g = 0;
 #ifdef HAVE_IRQ_DISABLE_ALL
       POS_IRQ_ENABLE_ALL;
 #endif
-      (softIntHandlers_g[intno])(softintqueue_g[sintIdxOut_g].param);
+      (dfunc)(darg);
 #ifdef HAVE_IRQ_DISABLE_ALL
       POS_IRQ_DISABLE_ALL;
 #endif
     }
-    if (++sintIdxOut_g > POSCFG_SOFTINTQUEUELEN)
-      sintIdxOut_g = 0;
+#endif
   }
-  while (sintIdxIn_g != sintIdxOut_g);
+  while (softIntsPending());
   --posInInterrupt_g;
 #ifdef HAVE_IRQ_DISABLE_ALL
   POS_IRQ_ENABLE_ALL;
@@ -682,12 +1558,11 @@ static void POSCALL pos_schedule(void)
 #endif
 
 #if SYS_TASKTABSIZE_Y > 1
-      ym = POS_FINDBIT(posReadyTasks_g.ymask);
+      ym = pos_findTableY(&posReadyTasks_g);
 #else
       ym = 0;
 #endif
-      xt = POS_FINDBIT_EX(posReadyTasks_g.xtable[ym],
-                          POS_NEXTROUNDROBIN(ym));
+      xt = pos_findTaskX(ym);
 
 #if (SYS_TASKTABSIZE_X > 1) && (POSCFG_ROUNDROBIN != 0)
       posNextRoundRobin_g[ym] = (xt + 1) & (SYS_TASKTABSIZE_X - 1);
@@ -715,46 +1590,353 @@ static void POSCALL pos_schedule(void)
 
 /*-------------------------------------------------------------------------*/
 
-#if SYS_FEATURE_EVENTS != 0
+#if POSCFG_FEATURE_EVENTWAITANY != 0
 
-static VAR_t POSCALL pos_sched_event(EVENT_t ev)
+#if POSCFG_FEATURE_MSGBOXES != 0
+#define pos_waitAnyEvent(task, obj) \
+  ((EVENT_t)(((obj)->type == POSWAIT_MSGBOX) ? \
+             (void*)(task)->msgsem : (obj)->handle))
+#else
+#define pos_waitAnyEvent(task, obj)  ((EVENT_t)(obj)->handle)
+#endif
+
+/* Set or clear the bit of a task in the pend tables of all objects
+ * it waits for with posEventWaitAny.
+ */
+static void POSCALL pos_waitAnyLink(POSTASK_t task, UVAR_t add);
+static void POSCALL pos_waitAnyLink(POSTASK_t task, UVAR_t add)
 {
-  register UVAR_t  ym, xt;
-  register POSTASK_t task;
+  register const POSWAITOBJ_t *obj = (const POSWAITOBJ_t*) task->waitany;
+  register EVENT_t ev;
+  register UVAR_t  i;
 
-#if POSCFG_FEATURE_SOFTINTS != 0
-  if (softIntsPending())
+  for (i = 0; i < task->waitanycnt; ++i, ++obj)
   {
-#ifdef POS_DEBUGHELP
-    posCurrentTask_g->deb.state = task_suspended;
+    ev = pos_waitAnyEvent(task, obj);
+    if (add)
+    {
+      pos_setTableBit(&ev->e.pend, task);
+#if POSCFG_FEATURE_MSGBOXES != 0
+      if (obj->type == POSWAIT_MSGBOX)
+        task->msgwait = 1;
 #endif
-    pos_schedule();
+    }
+    else
+    {
+      pos_delTableBit(&ev->e.pend, task);
+    }
   }
-#endif
+}
 
-#if SYS_TASKTABSIZE_Y > 1
-  if (ev->e.pend.ymask != 0)
-  {
-    ym = POS_FINDBIT(ev->e.pend.ymask);
-    xt = POS_FINDBIT_EX(ev->e.pend.xtable[ym],
-                        POS_NEXTROUNDROBIN(ym));
-#else
-  if (ev->e.pend.xtable[0] != 0)
+/* End the wait of a task in posEventWaitAny. ev is the event that
+ * woke the task up, or NULL on timeout. The task leaves all other
+ * wait lists at once, so no second event can be passed to it.
+ */
+static void POSCALL pos_waitAnyDone(POSTASK_t task, EVENT_t ev);
+static void POSCALL pos_waitAnyDone(POSTASK_t task, EVENT_t ev)
+{
+  register const POSWAITOBJ_t *obj = (const POSWAITOBJ_t*) task->waitany;
+  register UVAR_t  i;
+
+  for (i = 0; i < task->waitanycnt; ++i)
   {
-    ym = 0;
-    xt = POS_FINDBIT(ev->e.pend.xtable[0]);
+    if (pos_waitAnyEvent(task, &obj[i]) == ev)
+      break;
+  }
+  task->waitanyidx = i;
+  pos_waitAnyLink(task, 0);
+  task->waitany = NULL;
+#if POSCFG_FEATURE_MSGBOXES != 0
+  task->msgwait = 0;
 #endif
+}
 
-    task = posTaskTable_g[(ym * SYS_TASKTABSIZE_X) + xt];
+#endif  /* POSCFG_FEATURE_EVENTWAITANY */
 
-    pos_eventRemoveTask(ev, task);
-    pos_enableTask(task);
-    posMustSchedule_g = 1;
+/*-------------------------------------------------------------------------*/
 
-#if (POSCFG_SOFT_MTASK == 0) || (POSCFG_CTXSW_COMBINE == 1)
-    pos_schedule();
+#if (POSCFG_FEATURE_SETPRIORITY != 0) || (SYS_MUTEXBOOST != 0)
+
+static UVAR_t POSCALL pos_findTaskSlot(VAR_t priority, UVAR_t *py, UVAR_t *pb)
+{
+  register UVAR_t  b, p;
+
+#if POSCFG_ROUNDROBIN == 0
+  p = (SYS_TASKTABSIZE_Y - 1) - (priority / MVAR_BITS);
+  b = (~posAllocatedTasks_g.xtable[p]) &
+      pos_shift1l((MVAR_BITS-1) - (priority & (MVAR_BITS-1)));
 #else
-#if POSCFG_REALTIME_PRIO > 0
+  p = (SYS_TASKTABSIZE_Y - 1) - priority;
+  b = ~posAllocatedTasks_g.xtable[p];
+#endif
+  if (b == 0)
+    return 0;
+  b = POS_FINDBIT(b);
+#if (POSCFG_ROUNDROBIN != 0) && (SYS_TASKTABSIZE_X < MVAR_BITS)
+  if (b >= SYS_TASKTABSIZE_X)
+    return 0;
+#endif
+  *py = p;
+  *pb = b;
+  return 1;
+}
+
+/* Move a task to a new place in the task table. The caller must
+   already have released the allocation bit of the old place. */
+static void POSCALL pos_moveTask(POSTASK_t task, UVAR_t p, UVAR_t b)
+{
+  register EVENT_t  ev;
+  register int taskruns;
+
+  ev = (EVENT_t) task->event;
+  taskruns = pos_isTableBitSet(&posReadyTasks_g, task);
+  if (taskruns)
+  {
+    pos_disableTask(task);
+  }
+  else
+  {
+    if (ev != NULL)
+      pos_eventRemoveTask(ev, task);
+#if POSCFG_FEATURE_EVENTWAITANY != 0
+    if (task->waitany != NULL)
+      pos_waitAnyLink(task, 0);
+#endif
+  }
+  pos_setTaskIdxY(task, p);
+  task->bit_x = pos_shift1l(b);
+  posTaskTable_g[(p * SYS_TASKTABSIZE_X) + b] = task;
+  pos_setTableBit(&posAllocatedTasks_g, task);
+
+  if (taskruns)
+  {
+    pos_enableTask(task);
+  }
+  else
+  {
+    if (ev != NULL)
+      pos_eventAddTask(ev, task);
+#if POSCFG_FEATURE_EVENTWAITANY != 0
+    if (task->waitany != NULL)
+      pos_waitAnyLink(task, 1);
+#endif
+  }
+}
+
+#endif  /* POSCFG_FEATURE_SETPRIORITY || SYS_MUTEXBOOST */
+
+/*-------------------------------------------------------------------------*/
+
+#if SYS_MUTEXBOOST != 0
+
+#if SYS_TASKTABSIZE_Y > 1
+#define POS_IDX_Y(task)       ((task)->idx_y)
+#define POS_BASE_IDX_Y(task)  ((task)->base_idx_y)
+#define POS_YPRIO(y)          ((VAR_t)((SYS_TASKTABSIZE_Y - 1) - (y)))
+#else
+#define POS_IDX_Y(task)       0
+#define POS_BASE_IDX_Y(task)  0
+#define POS_YPRIO(y)          0
+#endif
+
+/* priority of the highest task in table row y with x-bitmask bx */
+#if POSCFG_ROUNDROBIN == 0
+#define pos_slotPrio(y, bx) \
+  ((VAR_t)((POS_YPRIO(y) * MVAR_BITS) + (MVAR_BITS - 1) - POS_FINDBIT(bx)))
+#else
+#define pos_slotPrio(y, bx)   POS_YPRIO(y)
+#endif
+
+#define pos_isAtBase(task) \
+  (((task)->bit_x == (task)->base_bit_x) && \
+   (POS_IDX_Y(task) == POS_BASE_IDX_Y(task)))
+
+#if SYS_TASKTABSIZE_Z > 1
+#define pos_delBaseSlot(task) do { \
+    UVAR_t tbt, by = (task)->base_idx_y; \
+    tbt  = posAllocatedTasks_g.xtable[by] & ~(task)->base_bit_x; \
+    posAllocatedTasks_g.xtable[by] = tbt; \
+    if (tbt == 0) { \
+      tbt  = posAllocatedTasks_g.ymask[pos_idxZ(by)] & \
+             ~pos_shift1l(by & (MVAR_BITS - 1)); \
+      posAllocatedTasks_g.ymask[pos_idxZ(by)] = tbt; \
+      if (tbt == 0) \
+        posAllocatedTasks_g.zmask &= ~pos_shift1l(pos_idxZ(by)); } \
+  } while(0)
+#elif SYS_TASKTABSIZE_Y > 1
+#define pos_delBaseSlot(task) do { \
+    UVAR_t tbt; \
+    tbt  = posAllocatedTasks_g.xtable[(task)->base_idx_y] & \
+           ~(task)->base_bit_x; \
+    posAllocatedTasks_g.xtable[(task)->base_idx_y] = tbt; \
+    if (tbt == 0) \
+      posAllocatedTasks_g.ymask &= ~pos_shift1l((task)->base_idx_y); \
+  } while(0)
+#else
+#define pos_delBaseSlot(task) do { \
+    posAllocatedTasks_g.xtable[0] &= ~(task)->base_bit_x; } while(0)
+#endif
+
+#define pos_mutexSetOwner(ev, tsk) do { \
+    (ev)->e.task  = (tsk); \
+    (ev)->e.mnext = (EVENT_t) (tsk)->mutexes; \
+    (tsk)->mutexes = (void*) (ev); } while(0)
+
+/* Recompute the priority of a mutex owner: it is the maximum of its
+   base priority, the ceilings of its mutexes and the priorities of all
+   tasks waiting for one of its mutexes. When the owner itself waits
+   for a mutex, the change is passed along the chain of owners. */
+static void POSCALL pos_mutexInherit(POSTASK_t task)
+{
+  register EVENT_t  ev;
+  register VAR_t    prio, cur;
+#if POSCFG_MUTEX_PRIO_INHERIT != 0
+  register VAR_t    p;
+#endif
+  UVAR_t  y, b;
+
+  while (task != NULL)
+  {
+    prio = pos_slotPrio(POS_BASE_IDX_Y(task), task->base_bit_x);
+    for (ev = (EVENT_t) task->mutexes; ev != NULL; ev = ev->e.mnext)
+    {
+#if POSCFG_FEATURE_MUTEXCEILING != 0
+      if (ev->e.ceiling > prio)
+        prio = ev->e.ceiling;
+#endif
+#if POSCFG_MUTEX_PRIO_INHERIT != 0
+#if SYS_TASKTABSIZE_Y > 1
+      if (pos_tableEmpty(&ev->e.pend))
+        continue;
+      y = pos_findTableY(&ev->e.pend);
+#else
+      if (ev->e.pend.xtable[0] == 0)
+        continue;
+      y = 0;
+#endif
+      p = pos_slotPrio(y, ev->e.pend.xtable[y]);
+      if (p > prio)
+        prio = p;
+#endif
+    }
+
+    if (prio == pos_slotPrio(POS_BASE_IDX_Y(task), task->base_bit_x))
+    {
+      if (pos_isAtBase(task))
+        break;
+      pos_delTableBit(&posAllocatedTasks_g, task);
+      y = POS_BASE_IDX_Y(task);
+      b = POS_FINDBIT(task->base_bit_x);
+    }
+    else
+    {
+      /* The base slot stays reserved. Take the first free slot at or
+         above the inherited priority, or keep the current boosted slot
+         if there is no better one below it. */
+      cur = pos_slotPrio(POS_IDX_Y(task), task->bit_x);
+      for (; prio < POSCFG_MAX_PRIO_LEVEL; ++prio)
+      {
+        if ((prio == cur) && !pos_isAtBase(task))
+          break;
+        if (pos_findTaskSlot(prio, &y, &b) != 0)
+          break;
+      }
+      if ((prio >= POSCFG_MAX_PRIO_LEVEL) || (prio == cur))
+        break;
+      if (!pos_isAtBase(task))
+        pos_delTableBit(&posAllocatedTasks_g, task);
+    }
+    pos_moveTask(task, y, b);
+
+    ev = (EVENT_t) task->event;
+    task = (ev != NULL) ? ev->e.task : NULL;
+  }
+}
+
+/* Remove a mutex from the list of mutexes held by its owner
+   and drop the priority the owner inherited through it.
+   Returns nonzero when the owner was running at a raised priority. */
+static UVAR_t POSCALL pos_mutexRelease(EVENT_t ev)
+{
+  register POSTASK_t task = ev->e.task;
+  register EVENT_t  m, prev = NULL;
+  register UVAR_t   boosted = !pos_isAtBase(task);
+
+  for (m = (EVENT_t) task->mutexes;
+       (m != NULL) && (m != ev); m = m->e.mnext)
+  {
+    prev = m;
+  }
+  if (m != NULL)
+  {
+    if (prev == NULL)
+      task->mutexes = (void*) ev->e.mnext;
+    else
+      prev->e.mnext = ev->e.mnext;
+  }
+  pos_mutexInherit(task);
+  return boosted;
+}
+
+#endif  /* SYS_MUTEXBOOST */
+
+/*-------------------------------------------------------------------------*/
+
+#if SYS_FEATURE_EVENTS != 0
+
+static VAR_t POSCALL pos_sched_event(EVENT_t ev)
+{
+  register UVAR_t  ym, xt;
+  register POSTASK_t task;
+
+#if POSCFG_FEATURE_SOFTINTS != 0
+  if (softIntsPending())
+  {
+#ifdef POS_DEBUGHELP
+    posCurrentTask_g->deb.state = task_suspended;
+#endif
+    pos_schedule();
+  }
+#endif
+
+#if SYS_TASKTABSIZE_Y > 1
+  if (!pos_tableEmpty(&ev->e.pend))
+  {
+    ym = pos_findTableY(&ev->e.pend);
+    xt = POS_FINDBIT_EX(ev->e.pend.xtable[ym],
+                        POS_NEXTROUNDROBIN(ym));
+#else
+  if (ev->e.pend.xtable[0] != 0)
+  {
+    ym = 0;
+    xt = POS_FINDBIT(ev->e.pend.xtable[0]);
+#endif
+
+    task = posTaskTable_g[(ym * SYS_TASKTABSIZE_X) + xt];
+
+    pos_eventRemoveTask(ev, task);
+#if POSCFG_FEATURE_EVENTWAITANY != 0
+    if (task->waitany != NULL)
+      pos_waitAnyDone(task, ev);
+#endif
+#if SYS_MUTEXBOOST != 0
+    /* mutex: hand over the lock before the new owner can be preempted */
+    if (ev->e.task != NULL)
+    {
+      pos_mutexSetOwner(ev, task);
+#if POSCFG_FEATURE_MUTEXCEILING != 0
+      if (ev->e.ceiling >= 0)
+        pos_mutexInherit(task);
+#endif
+    }
+#endif
+    pos_enableTask(task);
+    posMustSchedule_g = 1;
+
+#if (POSCFG_SOFT_MTASK == 0) || (POSCFG_CTXSW_COMBINE == 1)
+    pos_schedule();
+#else
+#if POSCFG_REALTIME_PRIO > 0
 #if (POSCFG_ROUNDROBIN != 0) && (SYS_TASKTABSIZE_Y > 1)
     if (task->idx_y  <  (SYS_TASKTABSIZE_Y - POSCFG_REALTIME_PRIO))
     {
@@ -781,6 +1963,114 @@ static VAR_t POSCALL pos_sched_event(EVENT_t ev)
 
 /*-------------------------------------------------------------------------*/
 
+#if (POSCFG_FEATURE_CONDVARS != 0) || (POSCFG_FEATURE_RWLOCKS != 0) || \
+    (POSCFG_FEATURE_MSGBOXLIMIT != 0)
+
+/* Move the bits of one row of the pend table to the ready table.
+ * The tasks are unlinked from the event when they know it.
+ */
+static void POSCALL pos_eventWakeRow(EVENT_t ev, UVAR_t y);
+static void POSCALL pos_eventWakeRow(EVENT_t ev, UVAR_t y)
+{
+#if (SYS_TASKEVENTLINK != 0) || defined(POS_DEBUGHELP) || \
+    (POSCFG_FEATURE_EDF != 0)
+  register POSTASK_t task;
+  register UVAR_t x, bits;
+
+  bits = ev->e.pend.xtable[y];
+  while (bits != 0)
+  {
+    x = POS_FINDBIT(bits);
+    bits &= ~pos_shift1l(x);
+    task = posTaskTable_g[(y * SYS_TASKTABSIZE_X) + x];
+#ifdef POS_DEBUGHELP
+    task->deb.event = NULL;
+#endif
+#if SYS_TASKEVENTLINK != 0
+    task->event = NULL;
+#endif
+#if POSCFG_FEATURE_EDF != 0
+    pos_edfInsert(task);
+#endif
+  }
+#endif
+  posReadyTasks_g.xtable[y] |= ev->e.pend.xtable[y];
+  ev->e.pend.xtable[y] = 0;
+}
+
+/* Make all tasks ready that pend on the event. The pend table is
+ * merged into the ready table word by word, only rows that have
+ * waiting tasks are touched.
+ */
+static void POSCALL pos_eventWakeAll(EVENT_t ev);
+static void POSCALL pos_eventWakeAll(EVENT_t ev)
+{
+#if SYS_TASKTABSIZE_Z > 1
+  register UVAR_t z, zm, y, m;
+
+  zm = ev->e.pend.zmask;
+  posReadyTasks_g.zmask |= zm;
+  ev->e.pend.zmask = 0;
+  while (zm != 0)
+  {
+    z = POS_FINDBIT(zm);
+    zm &= ~pos_shift1l(z);
+    m = ev->e.pend.ymask[z];
+    posReadyTasks_g.ymask[z] |= m;
+    ev->e.pend.ymask[z] = 0;
+    while (m != 0)
+    {
+      y = POS_FINDBIT(m);
+      m &= ~pos_shift1l(y);
+      pos_eventWakeRow(ev, (z * MVAR_BITS) + y);
+    }
+  }
+#elif SYS_TASKTABSIZE_Y > 1
+  register UVAR_t y, m;
+
+  m = ev->e.pend.ymask;
+  posReadyTasks_g.ymask |= m;
+  ev->e.pend.ymask = 0;
+  while (m != 0)
+  {
+    y = POS_FINDBIT(m);
+    m &= ~pos_shift1l(y);
+    pos_eventWakeRow(ev, y);
+  }
+#else
+  pos_eventWakeRow(ev, 0);
+#endif
+}
+
+#endif  /* CONDVARS || RWLOCKS || MSGBOXLIMIT */
+
+#if (POSCFG_FEATURE_MSGBOXLIMIT != 0) && (POSCFG_FEATURE_EXIT != 0)
+
+/* Mark the tasks that wait for space in the message box of an exiting
+ * task. The mark is kept in the waiting task, because the exiting task
+ * may be reused before a waiter runs again.
+ */
+static void POSCALL pos_msgSendAbort(EVENT_t ev);
+static void POSCALL pos_msgSendAbort(EVENT_t ev)
+{
+  register UVAR_t x, y, bits;
+
+  for (y = 0; y < SYS_TASKTABSIZE_Y; ++y)
+  {
+    bits = ev->e.pend.xtable[y];
+    while (bits != 0)
+    {
+      x = POS_FINDBIT(bits);
+      bits &= ~pos_shift1l(x);
+      posTaskTable_g[(y * SYS_TASKTABSIZE_X) + x]->msgsendexit = 1;
+    }
+  }
+}
+
+#endif
+
+/*-------------------------------------------------------------------------*/
+
 #if (POSCFG_FEATURE_TIMER != 0) && (POSCFG_FEATURE_TIMERCALLBACK != 0)
 static void pos_timerSemaSignal(POSTIMER_t timer, void* sema)
 {
@@ -862,12 +2152,11 @@ void POSCALL c_pos_intExit(void)
 #endif
 
 #if SYS_TASKTABSIZE_Y > 1
-          ym = POS_FINDBIT(posReadyTasks_g.ymask);
+          ym = pos_findTableY(&posReadyTasks_g);
 #else
           ym = 0;
 #endif
-          xt = POS_FINDBIT_EX(posReadyTasks_g.xtable[ym],
-                              POS_NEXTROUNDROBIN(ym));
+          xt = pos_findTaskX(ym);
 
           posNextTask_g = posTaskTable_g[(ym * SYS_TASKTABSIZE_X) + xt];
 
@@ -972,13 +2261,85 @@ void POSCALL c_pos_intExitQuick(void)
 
 /*-------------------------------------------------------------------------*/
 
+#if POSCFG_FEATURE_BUDGET != 0
+
+#if POSCFG_FEATURE_LARGEJIFFIES == 0
+#define pos_nowJiffies()  jiffies
+#else
+#define pos_nowJiffies()  pos_jiffies_g
+#endif
+
+/* Start the period that contains jiffy jif and refill the budget.
+ * Periods that passed without the task running are skipped.
+ */
+static void POSCALL pos_budgetRefill(POSTASK_t task, JIF_t jif);
+static void POSCALL pos_budgetRefill(POSTASK_t task, JIF_t jif)
+{
+  task->breplenish += (JIF_t) task->bperiod *
+    (JIF_t) (1 + (UINT_t) (jif - task->breplenish) / task->bperiod);
+  task->bleft = task->budget;
+}
+
+/* Make the throttled tasks ready again whose next period has begun.
+ * The list is sorted by replenish time, so only its head is tested.
+ */
+static void POSCALL pos_budgetReplenish(JIF_t jif);
+static void POSCALL pos_budgetReplenish(JIF_t jif)
+{
+  register POSTASK_t  task;
+
+  while (((task = posThrottledTasks_g) != NULL) &&
+         POS_TIMEAFTER(jif, task->breplenish))
+  {
+    posThrottledTasks_g = task->bnext;
+    task->throttled = 0;
+    pos_budgetRefill(task, jif);
+    pos_enableTask(task);
+  }
+}
+
+/* Charge the running task one tick. A task that has used up
+ * its budget leaves the ready list until its next period, it is
+ * inserted into the throttled list sorted by replenish time.
+ */
+static void POSCALL pos_budgetCharge(POSTASK_t task, JIF_t jif);
+static void POSCALL pos_budgetCharge(POSTASK_t task, JIF_t jif)
+{
+  register POSTASK_t  *prev;
+
+  if ((task->budget == 0) || (task->throttled != 0))
+    return;
+
+  if (POS_TIMEAFTER(jif, task->breplenish))
+    pos_budgetRefill(task, jif);
+
+  if (task->bleft != 0)
+    --task->bleft;
+
+  if ((task->bleft == 0) && pos_isTableBitSet(&posReadyTasks_g, task))
+  {
+    ++task->overruns;
+    task->throttled = 1;
+    pos_disableTask(task);
+    prev = &posThrottledTasks_g;
+    while ((*prev != NULL) &&
+           POS_TIMEAFTER(task->breplenish, (*prev)->breplenish))
+    {
+      prev = &(*prev)->bnext;
+    }
+    task->bnext = *prev;
+    *prev = task;
+  }
+}
+
+#endif  /* POSCFG_FEATURE_BUDGET */
+
+/*-------------------------------------------------------------------------*/
+
 void POSCALL c_pos_timerInterrupt(void)
 {
   register POSTASK_t  task;
-#if SYS_TASKDOUBLELINK == 0
-  register POSTASK_t  last = NULL;
-#endif
-#if POSCFG_FEATURE_TIMER != 0
+#if (POSCFG_FEATURE_TIMER != 0) && (POSCFG_TIMER_WHEEL == 0)
   register TIMER_t   *tmr;
 #endif
 #if POSCFG_ISR_INTERRUPTABLE != 0
@@ -1000,59 +2361,43 @@ void POSCALL c_pos_timerInterrupt(void)
 #endif
 #endif
 
+#if POSCFG_FEATURE_BUDGET != 0
+  pos_budgetReplenish(pos_nowJiffies());
+  pos_budgetCharge(posCurrentTask_g, pos_nowJiffies());
+#endif
+
 #if POSCFG_FEATURE_TIMER != 0
+#if POSCFG_TIMER_WHEEL != 0
+  pos_timerWheelTick();
+#else
   tmr = posActiveTimers_g;
-  while (tmr != NULL)
+  if (tmr != NULL)
   {
     --(tmr->counter);
-    if (tmr->counter == 0)
+    while ((tmr != NULL) && (tmr->counter == 0))
     {
-      pos_timerFired(tmr);
-#if POSCFG_FEATURE_TIMERFIRED != 0
-      tmr->fired = 1;
-#endif
-      if (tmr->reload != 0)
-      {
-        tmr->counter = tmr->reload;
-      }
-      else
-      {
-        pos_removeFromTimerList(tmr);
-      }
+      pos_timerExpired(tmr);
+      tmr = posActiveTimers_g;
     }
-    tmr = tmr->next;
   }
+#endif
 #endif
 
   task = posSleepingTasks_g;
-  while (task != NULL)
+  if (task != NULL)
   {
     --tasktimerticks(task);
-    if (tasktimerticks(task) == 0)
+    while ((task != NULL) && (tasktimerticks(task) == 0))
     {
       pos_enableTask(task);
+      posSleepingTasks_g = task->next;
 #if SYS_TASKDOUBLELINK != 0
-      pos_removeFromSleepList(task);
+      if (task->next != NULL)
+        task->next->prev = NULL;
       task->prev = task;
-    }
-    task = task->next;
-#else
-      task = task->next;
-      if (last == NULL)
-      {
-        posSleepingTasks_g = task;
-      }
-      else
-      {
-        last->next = task;
-      }
-    }
-    else
-    {
-      last = task;
-      task = task->next;
-    }
 #endif
+      task = posSleepingTasks_g;
+    }
   }
   posMustSchedule_g = 1;
 #if POSCFG_ISR_INTERRUPTABLE != 0
@@ -1062,18 +2407,65 @@ void POSCALL c_pos_timerInterrupt(void)
 
 /*-------------------------------------------------------------------------*/
 
-#if POSCFG_FEATURE_TICKLESS != 0
+#if POSCFG_FEATURE_HIRESTIMER != 0
 
-void POSCALL c_pos_timerStep(UVAR_t ticks)
+void POSCALL c_pos_hiresInterrupt(void)
 {
   register POSTASK_t  task;
-#if SYS_TASKDOUBLELINK == 0
-  register POSTASK_t  last = NULL;
-#endif
 #if POSCFG_FEATURE_TIMER != 0
   register TIMER_t   *tmr;
 #endif
-
+  register NSEC_t     now;
+#if POSCFG_ISR_INTERRUPTABLE != 0
+  POS_LOCKFLAGS;
+#endif
+
+  if (posRunning_g == 0)
+    return;
+
+#if POSCFG_ISR_INTERRUPTABLE != 0
+  POS_SCHED_LOCK;
+#endif
+
+  now = p_pos_hiresNow();
+
+#if POSCFG_FEATURE_TIMER != 0
+  while (((tmr = posHiresTimers_g) != NULL) &&
+         !NSEC_BEFORE(now, tmr->hrexpiry))
+  {
+    pos_hiresTimerExpired(tmr, now);
+  }
+#endif
+
+  while (((task = posHiresTasks_g) != NULL) &&
+         !NSEC_BEFORE(now, task->hrexpiry))
+  {
+    posHiresTasks_g = task->hrnext;
+    task->hrnext = task;
+    pos_enableTask(task);
+  }
+
+  pos_hiresProgram();
+  posMustSchedule_g = 1;
+#if POSCFG_ISR_INTERRUPTABLE != 0
+  POS_SCHED_UNLOCK;
+#endif
+}
+
+#endif  /* POSCFG_FEATURE_HIRESTIMER */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_TICKLESS != 0
+
+void POSCALL c_pos_timerStep(UVAR_t ticks)
+{
+  register POSTASK_t  task;
+#if (POSCFG_FEATURE_TIMER != 0) && (POSCFG_TIMER_WHEEL == 0)
+  register TIMER_t   *tmr;
+  register UVAR_t     ticksLeft;
+#endif
+
   POS_LOCKFLAGS;
 
   if (posRunning_g == 0)
@@ -1089,123 +2481,135 @@ void POSCALL c_pos_timerStep(UVAR_t ticks)
 #endif
 #endif
 
+#if POSCFG_FEATURE_BUDGET != 0
+  pos_budgetReplenish(pos_nowJiffies());
+#endif
+
 #if POSCFG_FEATURE_TIMER != 0
+#if POSCFG_TIMER_WHEEL != 0
 
-  register UVAR_t     ticksLeft;
+  pos_timerWheelAdvance(ticks);
+
+#else
 
+  ticksLeft = ticks;
   tmr = posActiveTimers_g;
   while (tmr != NULL)
   {
-    ticksLeft = ticks;
-
-    do {
-
-      if (ticksLeft > tmr->counter) {
-
-        ticksLeft -= tmr->counter;
-        tmr->counter = 0;
-      }
-      else {
+    if (ticksLeft < tmr->counter)
+    {
+      tmr->counter -= ticksLeft;
+      break;
+    }
 
-        tmr->counter -= ticksLeft;
-        ticksLeft = 0;
-      }
+    ticksLeft -= (UVAR_t) tmr->counter;
+    tmr->counter = 0;
+    pos_timerExpired(tmr);
+    tmr = posActiveTimers_g;
+  }
 
-      if (tmr->counter == 0)
-      {
-        pos_timerFired(tmr);
-#if POSCFG_FEATURE_TIMERFIRED != 0
-        tmr->fired = 1;
 #endif
-        if (tmr->reload != 0)
-        {
-          tmr->counter = tmr->reload;
-        }
-        else
-        {
-          pos_removeFromTimerList(tmr);
-        }
-      }
-    } while (ticksLeft > 0 && tmr->reload != 0);
-
-    tmr = tmr->next;
-  }
 #endif
 
   task = posSleepingTasks_g;
   while (task != NULL)
   {
-    if (ticks > tasktimerticks(task))
-      tasktimerticks(task) = 0;
-    else
+    if (ticks < tasktimerticks(task))
+    {
       tasktimerticks(task) -= ticks;
+      break;
+    }
 
-    if (tasktimerticks(task) == 0)
-    {
-      pos_enableTask(task);
+    ticks -= (UVAR_t) tasktimerticks(task);
+    tasktimerticks(task) = 0;
+    pos_enableTask(task);
+    posSleepingTasks_g = task->next;
 #if SYS_TASKDOUBLELINK != 0
-      pos_removeFromSleepList(task);
-      task->prev = task;
-    }
-    task = task->next;
-#else
-      task = task->next;
-      if (last == NULL)
-      {
-        posSleepingTasks_g = task;
-      }
-      else
-      {
-        last->next = task;
-      }
-    }
-    else
-    {
-      last = task;
-      task = task->next;
-    }
+    if (task->next != NULL)
+      task->next->prev = NULL;
+    task->prev = task;
 #endif
+    task = posSleepingTasks_g;
   }
 
   POS_SCHED_UNLOCK;
 }
 /*-------------------------------------------------------------------------*/
 
-UINT_t POSCALL c_pos_nextWakeup(void)
+static UINT_t POSCALL pos_nextWakeup(void);
+static UINT_t POSCALL pos_nextWakeup(void)
 {
-  register POSTASK_t  task;
+  register UINT_t  wake = INFINITE;
+#if POSCFG_FEATURE_BUDGET != 0
+  register UINT_t  t;
+#endif
+
 #if POSCFG_FEATURE_TIMER != 0
-  register TIMER_t   *tmr;
+#if POSCFG_TIMER_WHEEL != 0
+  wake = pos_timerWheelNext();
+#else
+  if (posActiveTimers_g != NULL)
+    wake = posActiveTimers_g->counter;
+#endif
 #endif
-  UINT_t wake = INFINITE;
-  POS_LOCKFLAGS;
 
-  POS_SCHED_LOCK;
+  if ((posSleepingTasks_g != NULL) &&
+      (wake == INFINITE || tasktimerticks(posSleepingTasks_g) < wake))
+    wake = tasktimerticks(posSleepingTasks_g);
 
-#if POSCFG_FEATURE_TIMER != 0
-  tmr = posActiveTimers_g;
-  while (tmr != NULL)
+#if POSCFG_FEATURE_BUDGET != 0
+  if (posThrottledTasks_g != NULL)
   {
-    if (wake == INFINITE || tmr->counter < wake)
-      wake = tmr->counter;
-
-    tmr = tmr->next;
+    t = (UINT_t) (posThrottledTasks_g->breplenish - pos_nowJiffies());
+    if (wake == INFINITE || t < wake)
+      wake = t;
   }
 #endif
 
-  task = posSleepingTasks_g;
-  while (task != NULL)
-  {
-    if (wake == INFINITE || tasktimerticks(task) < wake)
-      wake = tasktimerticks(task);
+  return wake;
+}
 
-    task = task->next;
-  }
+/*-------------------------------------------------------------------------*/
 
+UINT_t POSCALL c_pos_nextWakeup(void)
+{
+  UINT_t wake;
+  POS_LOCKFLAGS;
+
+  POS_SCHED_LOCK;
+  wake = pos_nextWakeup();
   POS_SCHED_UNLOCK;
   return wake;
 }
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_JIFFIES != 0
+
+UVAR_t POSCALL c_pos_nextWakeupJiffies(JIF_t *wakeup)
+{
+  UINT_t wake;
+  JIF_t  jif;
+  POS_LOCKFLAGS;
+
+  POS_SCHED_LOCK;
+  wake = pos_nextWakeup();
+#if POSCFG_FEATURE_LARGEJIFFIES == 0
+  jif = jiffies;
+#else
+  jif = pos_jiffies_g;
 #endif
+  POS_SCHED_UNLOCK;
+
+  if (wake == INFINITE)
+    return 0;
+
+  *wakeup = jif + (JIF_t) wake;
+  return 1;
+}
+
+#endif  /* POSCFG_FEATURE_JIFFIES */
+#endif  /* POSCFG_FEATURE_TICKLESS */
 
 /*---------------------------------------------------------------------------
  * EXPORTED FUNCTIONS:  TASK CONTROL
@@ -1252,18 +2656,21 @@ void POSCALL posTaskYield(void)
       posCtxCombineCtr_g = 0;
 #endif
 
-      ym = POS_FINDBIT(posReadyTasks_g.ymask);
+      ym = pos_findTableY(&posReadyTasks_g);
       if (ym == p)
       {
         if ((UVAR_t)(posReadyTasks_g.xtable[ym] &
             ~posCurrentTask_g->bit_x) == 0)
         {
+#if SYS_TASKTABSIZE_Z > 1
+          ym = pos_findTableNextY3(&posReadyTasks_g, ym);
+#else
           ym = POS_FINDBIT(posReadyTasks_g.ymask & pos_zmask(ym));
+#endif
         }
       }
 
-      xt = POS_FINDBIT_EX(posReadyTasks_g.xtable[ym],
-                          POS_NEXTROUNDROBIN(ym));
+      xt = pos_findTaskX(ym);
 
 #if SYS_TASKTABSIZE_X > 1
       posNextRoundRobin_g[ym] = (xt + 1) & (SYS_TASKTABSIZE_X - 1);
@@ -1294,7 +2701,29 @@ void POSCALL posTaskYield(void)
 
 /*-------------------------------------------------------------------------*/
 
+#if POSCFG_FEATURE_EDF != 0
+
+/* posTaskCreate and posTaskCreateDeadline share the same code. The
+ * EDF parameters must be set before the new task is made ready.
+ */
 #if POSCFG_TASKSTACKTYPE == 0
+#define TASKSTACK_PARAM   , void *stackstart
+#define TASKSTACK_ARG     , stackstart
+#elif POSCFG_TASKSTACKTYPE == 1
+#define TASKSTACK_PARAM   , UINT_t stacksize
+#define TASKSTACK_ARG     , stacksize
+#else
+#define TASKSTACK_PARAM
+#define TASKSTACK_ARG
+#endif
+
+static POSTASK_t POSCALL pos_taskCreate(POSTASKFUNC_t funcptr, void *funcarg,
+                                        VAR_t priority TASKSTACK_PARAM,
+                                        UINT_t period, UINT_t deadline);
+static POSTASK_t POSCALL pos_taskCreate(POSTASKFUNC_t funcptr, void *funcarg,
+                                        VAR_t priority TASKSTACK_PARAM,
+                                        UINT_t period, UINT_t deadline)
+#elif POSCFG_TASKSTACKTYPE == 0
 POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
                                 VAR_t priority, void *stackstart)
 #elif POSCFG_TASKSTACKTYPE == 1
@@ -1370,12 +2799,18 @@ POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
 #if SYS_TASKEVENTLINK != 0
   task->event = NULL;
 #endif
-#if SYS_TASKTABSIZE_Y > 1
-  task->idx_y = p;
-  task->bit_y = pos_shift1l(p);
+#if POSCFG_FEATURE_EVENTWAITANY != 0
+  task->waitany = NULL;
 #endif
+  pos_setTaskIdxY(task, p);
   task->bit_x = pos_shift1l(b);
   posTaskTable_g[(p * SYS_TASKTABSIZE_X) + b] = task;
+#if SYS_MUTEXBOOST != 0
+  task->base_bit_x = task->bit_x;
+#if SYS_TASKTABSIZE_Y > 1
+  task->base_idx_y = p;
+#endif
+#endif
 
 #if POSCFG_TASKSTACKTYPE == 0
   p_pos_initTask(task, stackstart, funcptr, funcarg);
@@ -1397,6 +2832,19 @@ POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
 
 #if SYS_TASKSTATE != 0
   task->state = POSTASKSTATE_ACTIVE;
+#endif
+#if POSCFG_FEATURE_EDF != 0
+  if (period != 0)
+  {
+    task->edfperiod   = period;
+    task->edfreldl    = deadline;
+#if POSCFG_FEATURE_LARGEJIFFIES == 0
+    task->edfrelease  = jiffies;
+#else
+    task->edfrelease  = pos_jiffies_g;
+#endif
+    task->edfdeadline = task->edfrelease + (JIF_t) deadline;
+  }
 #endif
   pos_setTableBit(&posAllocatedTasks_g, task);
   pos_enableTask(task);
@@ -1428,6 +2876,105 @@ retNull:
   return NULL;
 }
 
+#if POSCFG_FEATURE_EDF != 0
+
+#if POSCFG_TASKSTACKTYPE == 0
+POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
+                                VAR_t priority, void *stackstart)
+#elif POSCFG_TASKSTACKTYPE == 1
+POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
+                                VAR_t priority, UINT_t stacksize)
+#else
+POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
+                                VAR_t priority)
+#endif
+{
+  /* the EDF priority is reserved for tasks of the EDF class */
+  if (priority == POSCFG_EDF_PRIO)
+    return NULL;
+  return pos_taskCreate(funcptr, funcarg, priority TASKSTACK_ARG, 0, 0);
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_TASKSTACKTYPE == 0
+POSTASK_t POSCALL posTaskCreateDeadline(POSTASKFUNC_t funcptr, void *funcarg,
+                                        UINT_t period, UINT_t deadline,
+                                        void *stackstart)
+#elif POSCFG_TASKSTACKTYPE == 1
+POSTASK_t POSCALL posTaskCreateDeadline(POSTASKFUNC_t funcptr, void *funcarg,
+                                        UINT_t period, UINT_t deadline,
+                                        UINT_t stacksize)
+#else
+POSTASK_t POSCALL posTaskCreateDeadline(POSTASKFUNC_t funcptr, void *funcarg,
+                                        UINT_t period, UINT_t deadline)
+#endif
+{
+#if POSCFG_ARGCHECK != 0
+  if ((period == 0) || (deadline > period))
+    return NULL;
+#endif
+  if (deadline == 0)
+    deadline = period;
+  return pos_taskCreate(funcptr, funcarg, POSCFG_EDF_PRIO TASKSTACK_ARG,
+                        period, deadline);
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posTaskWaitNextPeriod(void)
+{
+  register POSTASK_t task = posCurrentTask_g;
+  register VAR_t  missed;
+  register JIF_t  jif;
+  POS_LOCKFLAGS;
+
+#if POSCFG_ARGCHECK > 1
+  if (posInInterrupt_g != 0)
+    return -E_FORB;
+#endif
+  if (task->edfperiod == 0)
+    return -E_FORB;
+
+  POS_SCHED_LOCK;
+#if POSCFG_FEATURE_LARGEJIFFIES == 0
+  jif = jiffies;
+#else
+  jif = pos_jiffies_g;
+#endif
+  missed = EDF_BEFORE(task->edfdeadline, jif) ? 1 : 0;
+
+  /* The deadline changes, so the task must leave the heap first. */
+  pos_disableTask(task);
+  do
+  {
+    task->edfrelease += (JIF_t) task->edfperiod;
+    task->edfdeadline = task->edfrelease + (JIF_t) task->edfreldl;
+  }
+  while (EDF_BEFORE(task->edfdeadline, jif));
+
+  if (EDF_BEFORE(jif, task->edfrelease))
+  {
+    tasktimerticks(task) = (UINT_t) (task->edfrelease - jif);
+    pos_addToSleepList(task);
+#ifdef POS_DEBUGHELP
+    task->deb.state = task_sleeping;
+#endif
+  }
+  else
+  {
+    pos_enableTask(task);
+#ifdef POS_DEBUGHELP
+    task->deb.state = task_suspended;
+#endif
+  }
+  pos_schedule();
+  POS_SCHED_UNLOCK;
+  return missed;
+}
+
+#endif  /* POSCFG_FEATURE_EDF */
+
 /*-------------------------------------------------------------------------*/
 
 #if POSCFG_FEATURE_EXIT != 0
@@ -1435,6 +2982,9 @@ retNull:
 void POSCALL posTaskExit(void)
 {
   register POSTASK_t task = posCurrentTask_g;
+#if (POSCFG_FEATURE_MSGBOXES != 0) && (POSCFG_MSG_SIZECLASSES > 1)
+  MSGBUF_t  *mbuf;
+#endif
   POS_LOCKFLAGS;
 
 #if POSCFG_PORTMUTEX != 0
@@ -1445,29 +2995,59 @@ void POSCALL posTaskExit(void)
     (task->exithook)(task, texh_exitcalled);
 #endif
 #if POSCFG_FEATURE_MSGBOXES != 0
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+  if (task->msgsendsem != NULL)
+  {
+    /* release the tasks that wait for space in the message box */
+    POS_SCHED_LOCK;
+    task->state = POSTASKSTATE_ZOMBIE;
+    pos_msgSendAbort((EVENT_t) task->msgsendsem);
+    pos_eventWakeAll((EVENT_t) task->msgsendsem);
+    posMustSchedule_g = 1;
+    pos_schedule();
+    POS_SCHED_UNLOCK;
+    posSemaDestroy(task->msgsendsem);
+  }
+#endif
   if (task->msgsem != NULL)
   {
     posSemaDestroy(task->msgsem);
   }
   POS_SCHED_LOCK;
   task->state = POSTASKSTATE_ZOMBIE;
+#if POSCFG_MSG_SIZECLASSES > 1
+  /* the buffers may belong to different size classes */
+  while (task->firstmsg != NULL)
+  {
+    mbuf = (MSGBUF_t*)(task->firstmsg);
+    task->firstmsg = (void*) mbuf->next;
+    POS_SCHED_UNLOCK;
+    pos_msgFree(mbuf);
+    POS_SCHED_LOCK;
+  }
+#else
   if (task->firstmsg != NULL)
   {
-    ((MSGBUF_t*)(task->lastmsg))->next = posFreeMessagebuf_g;
-    posFreeMessagebuf_g = (MSGBUF_t*)(task->firstmsg);
-    if (msgAllocWaitReq_g != 0)
+    ((MSGBUF_t*)(task->lastmsg))->next = posMsgClass_g[0].freebuf;
+    posMsgClass_g[0].freebuf = (MSGBUF_t*)(task->firstmsg);
+    if (posMsgClass_g[0].waitreq != 0)
     {
-      msgAllocWaitReq_g = 0;
+      posMsgClass_g[0].waitreq = 0;
       POS_SCHED_UNLOCK;
-      posSemaSignal(msgAllocWaitSem_g);
+      posSemaSignal(posMsgClass_g[0].allocwait);
       POS_SCHED_LOCK;
     }
   }
+#endif
 #else
   POS_SCHED_LOCK;
 #endif
   pos_disableTask(task);
   pos_delTableBit(&posAllocatedTasks_g, task);
+#if SYS_MUTEXBOOST != 0
+  if (!pos_isAtBase(task))
+    pos_delBaseSlot(task);
+#endif
 #if (POSCFG_TASKSTACKTYPE == 1) || (POSCFG_TASKSTACKTYPE == 2)
   p_pos_freeStack(task);
 #endif
@@ -1529,67 +3109,47 @@ VAR_t POSCALL posTaskUnused(POSTASK_t taskhandle)
 
 VAR_t POSCALL posTaskSetPriority(POSTASK_t taskhandle, VAR_t priority)
 {
-  register UVAR_t  b, p;
+  UVAR_t  b, p;
+#if POSCFG_MUTEX_PRIO_INHERIT != 0
   register EVENT_t  ev;
-  register int taskruns;
+#endif
   POS_LOCKFLAGS;
 
   P_ASSERT("posTaskSetPriority: task handle valid", taskhandle != NULL);
   POS_ARGCHECK_RET(taskhandle, taskhandle->magic, POSMAGIC_TASK, -E_ARG); 
   if ((UVAR_t)priority >= POSCFG_MAX_PRIO_LEVEL)
     return -E_ARG;
+#if POSCFG_FEATURE_EDF != 0
+  if ((priority == POSCFG_EDF_PRIO) && (taskhandle->edfperiod == 0))
+    return -E_ARG;
+#endif
 
   POS_SCHED_LOCK;
-#if POSCFG_ROUNDROBIN == 0
-  p = (SYS_TASKTABSIZE_Y - 1) - (priority / MVAR_BITS);
-  b = (~posAllocatedTasks_g.xtable[p]) &
-      pos_shift1l((MVAR_BITS-1) - (priority & (MVAR_BITS-1)));
-#else
-  p = (SYS_TASKTABSIZE_Y - 1) - priority;
-  b = ~posAllocatedTasks_g.xtable[p];
-#endif
-  if (b == 0)
-  {
-    POS_SCHED_UNLOCK;
-    return -E_FAIL;
-  }
-  b = POS_FINDBIT(b);
-#if (POSCFG_ROUNDROBIN != 0) && (SYS_TASKTABSIZE_X < MVAR_BITS)
-  if (b >= SYS_TASKTABSIZE_X)
+  if (pos_findTaskSlot(priority, &p, &b) == 0)
   {
     POS_SCHED_UNLOCK;
     return -E_FAIL;
   }
+#if SYS_MUTEXBOOST != 0
+  if (!pos_isAtBase(taskhandle))
+    pos_delBaseSlot(taskhandle);
+#endif
+  pos_delTableBit(&posAllocatedTasks_g, taskhandle);
+  pos_moveTask(taskhandle, p, b);
+#if SYS_MUTEXBOOST != 0
+  taskhandle->base_bit_x = taskhandle->bit_x;
+#if SYS_TASKTABSIZE_Y > 1
+  taskhandle->base_idx_y = p;
 #endif
+  /* the task may still need a boost */
+  pos_mutexInherit(taskhandle);
+#if POSCFG_MUTEX_PRIO_INHERIT != 0
+  /* an owner the task waits for may need a different boost */
   ev = (EVENT_t) taskhandle->event;
-  taskruns = pos_isTableBitSet(&posReadyTasks_g, taskhandle);
-  if (taskruns)
-  {
-    pos_disableTask(taskhandle);
-  }
-  else
-  {
-    if (ev != NULL)
-      pos_eventRemoveTask(ev, taskhandle);
-  }
-  pos_delTableBit(&posAllocatedTasks_g, taskhandle);
-#if SYS_TASKTABSIZE_Y > 1
-  taskhandle->idx_y = p;
-  taskhandle->bit_y = pos_shift1l(p);
+  if (ev != NULL)
+    pos_mutexInherit(ev->e.task);
+#endif
 #endif
-  taskhandle->bit_x = pos_shift1l(b);
-  posTaskTable_g[(p * SYS_TASKTABSIZE_X) + b] = taskhandle;
-  pos_setTableBit(&posAllocatedTasks_g, taskhandle);
-
-  if (taskruns)
-  {
-    pos_enableTask(taskhandle);
-  }
-  else
-  {
-    if (ev != NULL)
-      pos_eventAddTask(ev, taskhandle);
-  }
   POS_SCHED_UNLOCK;
   return E_OK;
 }
@@ -1624,6 +3184,51 @@ VAR_t POSCALL posTaskGetPriority(POSTASK_t taskhandle)
 
 /*-------------------------------------------------------------------------*/
 
+#if POSCFG_FEATURE_BUDGET != 0
+
+VAR_t POSCALL posTaskSetBudget(POSTASK_t taskhandle,
+                               UINT_t budget, UINT_t period)
+{
+  register POSTASK_t  task, *prev;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posTaskSetBudget: task handle valid", taskhandle != NULL);
+  POS_ARGCHECK_RET(taskhandle, taskhandle->magic, POSMAGIC_TASK, -E_ARG); 
+  if ((budget != 0) && ((period == 0) || (budget > period)))
+    return -E_ARG;
+
+  POS_SCHED_LOCK;
+  taskhandle->budget     = budget;
+  taskhandle->bperiod    = period;
+  taskhandle->bleft      = budget;
+  taskhandle->breplenish = pos_nowJiffies() + (JIF_t) period;
+  if (taskhandle->throttled != 0)
+  {
+    prev = &posThrottledTasks_g;
+    while ((task = *prev) != taskhandle)
+      prev = &task->bnext;
+    *prev = task->bnext;
+    taskhandle->throttled = 0;
+    pos_enableTask(taskhandle);
+    pos_schedule();
+  }
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+UINT_t POSCALL posTaskOverrunCount(POSTASK_t taskhandle)
+{
+  P_ASSERT("posTaskOverrunCount: task handle valid", taskhandle != NULL);
+  POS_ARGCHECK_RET(taskhandle, taskhandle->magic, POSMAGIC_TASK, 0); 
+  return taskhandle->overruns;
+}
+
+#endif  /* POSCFG_FEATURE_BUDGET */
+
+/*-------------------------------------------------------------------------*/
+
 #if POSCFG_FEATURE_SLEEP != 0
 
 void POSCALL posTaskSleep(UINT_t ticks)
@@ -1651,6 +3256,37 @@ void POSCALL posTaskSleep(UINT_t ticks)
   POS_SCHED_UNLOCK;
 }
 
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_HIRESTIMER != 0
+
+void POSCALL posTaskSleepNs(NSEC_t ns)
+{
+  register POSTASK_t task = posCurrentTask_g;
+  POS_LOCKFLAGS;
+
+#if POSCFG_ARGCHECK > 1
+  if (posInInterrupt_g != 0)
+    return;
+#endif
+
+  POS_SCHED_LOCK;
+  if (ns != 0)
+  {
+    task->hrexpiry = p_pos_hiresNow() + ns;
+    pos_disableTask(task);
+    pos_hiresAddTask(task);
+  }
+#ifdef POS_DEBUGHELP
+  task->deb.state = task_sleeping;
+#endif
+  pos_schedule();
+  if ((ns != 0) && (task->hrnext != task))
+    pos_hiresRemoveTask(task);
+  POS_SCHED_UNLOCK;
+}
+
+#endif  /* POSCFG_FEATURE_HIRESTIMER */
 #endif  /* POSCFG_FEATURE_SLEEP */
 
 /*-------------------------------------------------------------------------*/
@@ -1801,12 +3437,21 @@ POSSEMA_t POSCALL posSemaCreate(INT_t initcount)
     ev->e.d.counter = initcount;
 #if POSCFG_FEATURE_MUTEXES != 0
     ev->e.task = NULL;
+#endif
+#if POSCFG_FEATURE_MUTEXCEILING != 0
+    ev->e.ceiling = -1;
 #endif
     for (i=0; i<SYS_TASKTABSIZE_Y; ++i)
     {
       ev->e.pend.xtable[i] = 0;
     }
-#if SYS_TASKTABSIZE_Y > 1
+#if SYS_TASKTABSIZE_Z > 1
+    for (i=0; i<SYS_TASKTABSIZE_Z; ++i)
+    {
+      ev->e.pend.ymask[i] = 0;
+    }
+    ev->e.pend.zmask = 0;
+#elif SYS_TASKTABSIZE_Y > 1
     ev->e.pend.ymask = 0;
 #endif
 #ifdef POS_DEBUGHELP
@@ -1843,7 +3488,7 @@ void POSCALL posSemaDestroy(POSSEMA_t sema)
 #endif
   POS_ARGCHECK(ev, ev->e.magic, POSMAGIC_EVENTU); 
 #if SYS_TASKTABSIZE_Y > 1
-  if (ev->e.pend.ymask == 0)
+  if (pos_tableEmpty(&ev->e.pend))
 #else
   if (ev->e.pend.xtable[0] == 0)
 #endif
@@ -1978,8 +3623,8 @@ VAR_t POSCALL posSemaWait(POSSEMA_t sema, UINT_t timeoutticks)
       }
       else
       {
-        cleartimerticks(task);
         pos_removeFromSleepList(task);
+        cleartimerticks(task);
       }
     }
   }
@@ -1987,6 +3632,71 @@ VAR_t POSCALL posSemaWait(POSSEMA_t sema, UINT_t timeoutticks)
   return E_OK;
 }
 
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_HIRESTIMER != 0
+
+VAR_t POSCALL posSemaWaitNs(POSSEMA_t sema, NSEC_t timeoutns)
+{
+  register EVENT_t   ev = (EVENT_t) sema;
+  register POSTASK_t task = posCurrentTask_g;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posSemaWaitNs: semaphore valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posSemaWaitNs: semaphore allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  P_ASSERT("posSemaWaitNs: not in an interrupt", posInInterrupt_g == 0);
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+#if POSCFG_ARGCHECK > 1
+  if (posInInterrupt_g != 0)
+    return -E_FORB;
+#endif
+  POS_SCHED_LOCK;
+
+  if (ev->e.d.counter > 0)
+  {
+    --(ev->e.d.counter);
+#ifdef POS_DEBUGHELP
+    ev->e.deb.counter = ev->e.d.counter;
+#endif
+  }
+  else
+  {
+    if (timeoutns == 0)
+    {
+      POS_SCHED_UNLOCK;
+      return 1;
+    }
+    task->hrexpiry = p_pos_hiresNow() + timeoutns;
+    pos_hiresAddTask(task);
+#ifdef POS_DEBUGHELP
+    task->deb.state = task_waitingForSemaphoreWithTimeout;
+#endif
+    pos_disableTask(task);
+    pos_eventAddTask(ev, task);
+    pos_schedule();
+
+    if (task->hrnext == task)
+    {
+      if (pos_isTableBitSet(&ev->e.pend, task))
+      {
+        pos_eventRemoveTask(ev, task);
+        POS_SCHED_UNLOCK;
+        return 1;
+      }
+    }
+    else
+    {
+      pos_hiresRemoveTask(task);
+    }
+  }
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+#endif  /* POSCFG_FEATURE_HIRESTIMER */
 #endif  /* POSCFG_FEATURE_SEMAWAIT */
 
 /*-------------------------------------------------------------------------*/
@@ -2038,116 +3748,541 @@ VAR_t POSCALL posSemaSignal(POSSEMA_t sema)
 
 #if POSCFG_FEATURE_MUTEXES != 0
 
-POSMUTEX_t POSCALL posMutexCreate(void)
+POSMUTEX_t POSCALL posMutexCreate(void)
+{
+#ifdef POS_DEBUGHELP
+  EVENT_t ev = (EVENT_t) posSemaCreate(1);
+  if (ev != NULL) ev->e.deb.type = event_mutex;
+  return (POSMUTEX_t) ev;
+#else
+  return (POSMUTEX_t) posSemaCreate(1);
+#endif
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_MUTEXCEILING != 0
+
+POSMUTEX_t POSCALL posMutexCreateCeiling(VAR_t priority)
+{
+  register EVENT_t ev;
+
+  if ((UVAR_t)priority >= POSCFG_MAX_PRIO_LEVEL)
+    return NULL;
+  ev = (EVENT_t) posMutexCreate();
+  if (ev != NULL)
+    ev->e.ceiling = priority;
+  return (POSMUTEX_t) ev;
+}
+
+#endif  /* POSCFG_FEATURE_MUTEXCEILING */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_MUTEXDESTROY != 0
+
+void POSCALL posMutexDestroy(POSMUTEX_t mutex)
+{
+  P_ASSERT("posMutexDestroy: mutex valid", mutex != NULL);
+  posSemaDestroy((POSSEMA_t) mutex);
+}
+
+#endif  /* POSCFG_FEATURE_MUTEXDESTROY */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_MUTEXTRYLOCK != 0
+
+VAR_t POSCALL posMutexTryLock(POSMUTEX_t mutex)
+{
+  register EVENT_t  ev = (EVENT_t) mutex;
+  register POSTASK_t task = posCurrentTask_g;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posMutexTryLock: mutex valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posMutexTryLock: mutex allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  POS_SCHED_LOCK;
+
+  if (ev->e.task == task)
+  {
+    --(ev->e.d.counter);
+#ifdef POS_DEBUGHELP
+    ev->e.deb.counter = ev->e.d.counter;
+#endif
+  }
+  else
+  {
+    if (ev->e.d.counter < 1)
+    {
+      POS_SCHED_UNLOCK;
+      return 1;  /* no lock */
+    }
+    ev->e.d.counter = 0;
+#if SYS_MUTEXBOOST != 0
+    pos_mutexSetOwner(ev, task);
+#if POSCFG_FEATURE_MUTEXCEILING != 0
+    if (ev->e.ceiling >= 0)
+      pos_mutexInherit(task);
+#endif
+#else
+    ev->e.task = task;
+#endif
+#ifdef POS_DEBUGHELP
+    ev->e.deb.counter = 0;
+#endif
+  }
+  POS_SCHED_UNLOCK;
+  return 0;  /* have lock */
+}
+
+#endif  /* POSCFG_FEATURE_MUTEXTRYLOCK */
+
+/*-------------------------------------------------------------------------*/
+
+/* Lock and unlock a mutex. The caller holds the scheduler lock. */
+static void POSCALL pos_mutexLock(EVENT_t ev, POSTASK_t task);
+static void POSCALL pos_mutexLock(EVENT_t ev, POSTASK_t task)
+{
+  if (ev->e.task == task)
+  {
+    --(ev->e.d.counter);
+#ifdef POS_DEBUGHELP
+    ev->e.deb.counter = ev->e.d.counter;
+#endif
+  }
+  else
+  {
+    if (ev->e.d.counter > 0)
+    {
+      ev->e.d.counter = 0;
+#ifdef POS_DEBUGHELP
+      ev->e.deb.counter = 0;
+#endif
+#if SYS_MUTEXBOOST != 0
+      pos_mutexSetOwner(ev, task);
+#endif
+#if POSCFG_FEATURE_MUTEXCEILING != 0
+      /* immediate ceiling: no task that shares this mutex
+         can preempt us until it is unlocked again */
+      if (ev->e.ceiling >= 0)
+        pos_mutexInherit(task);
+#endif
+    }
+    else
+    {
+      pos_disableTask(task);
+      pos_eventAddTask(ev, task);
+#ifdef POS_DEBUGHELP
+      task->deb.state = task_waitingForMutex;
+#endif
+#if POSCFG_MUTEX_PRIO_INHERIT != 0
+      /* the lock is handed over to us by posMutexUnlock */
+      pos_mutexInherit(ev->e.task);
+#endif
+      pos_schedule();
+    }
+#if SYS_MUTEXBOOST == 0
+    ev->e.task = task;
+#endif
+  }
+}
+
+static void POSCALL pos_mutexUnlock(EVENT_t ev);
+static void POSCALL pos_mutexUnlock(EVENT_t ev)
+{
+#if SYS_MUTEXBOOST != 0
+  register UVAR_t   boosted;
+#endif
+
+  if (ev->e.d.counter == 0)
+  {
+#if SYS_MUTEXBOOST != 0
+    boosted = pos_mutexRelease(ev);
+    if (pos_sched_event(ev) == 0)
+    {
+      ev->e.task = NULL;
+#else
+    ev->e.task = NULL;
+    if (pos_sched_event(ev) == 0)
+    {
+#endif
+      ev->e.d.counter = 1;
+#ifdef POS_DEBUGHELP
+      ev->e.deb.counter = 1;
+#endif
+    }
+#if SYS_MUTEXBOOST != 0
+    /* let a task run that got ready while we were boosted */
+    if (boosted)
+      pos_schedule();
+#endif
+  }
+  else
+  {
+    ++(ev->e.d.counter);
+#ifdef POS_DEBUGHELP
+    ev->e.deb.counter = ev->e.d.counter;
+#endif
+  }
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posMutexLock(POSMUTEX_t mutex)
+{
+  register EVENT_t  ev = (EVENT_t) mutex;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posMutexLock: mutex valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posMutexLock: mutex allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  P_ASSERT("posMutexLock: not in an interrupt", posInInterrupt_g == 0);
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  POS_SCHED_LOCK;
+  pos_mutexLock(ev, posCurrentTask_g);
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posMutexUnlock(POSMUTEX_t mutex)
+{
+  register EVENT_t  ev = (EVENT_t) mutex;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posMutexUnlock: mutex valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posMutexUnlock: mutex allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  POS_SCHED_LOCK;
+  pos_mutexUnlock(ev);
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+#endif  /* POSCFG_FEATURE_MUTEXES */
+
+
+
+/*---------------------------------------------------------------------------
+ * EXPORTED FUNCTIONS:  CONDITION VARIABLES
+ *-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_CONDVARS != 0
+
+POSCOND_t POSCALL posCondCreate(void)
+{
+  register EVENT_t ev;
+
+  ev = (EVENT_t) posSemaCreate(0);
+#ifdef POS_DEBUGHELP
+  if (ev != NULL)
+    ev->e.deb.type = event_condvar;
+#endif
+  return (POSCOND_t) ev;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL posCondDestroy(POSCOND_t cond)
+{
+  P_ASSERT("posCondDestroy: condition variable valid", cond != NULL);
+  posSemaDestroy((POSSEMA_t) cond);
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posCondWait(POSCOND_t cond, POSMUTEX_t mutex,
+                          UINT_t timeoutticks)
+{
+  register EVENT_t   ev = (EVENT_t) cond;
+  register EVENT_t   mev = (EVENT_t) mutex;
+  register POSTASK_t task = posCurrentTask_g;
+  register VAR_t     rc = E_OK;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posCondWait: condition variable valid", ev != NULL);
+  P_ASSERT("posCondWait: mutex valid", mev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posCondWait: condition variable allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+  P_ASSERT("posCondWait: mutex allocated",
+           mev->e.magic == POSMAGIC_EVENTU);
+#endif
+  P_ASSERT("posCondWait: not in an interrupt", posInInterrupt_g == 0);
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  POS_ARGCHECK_RET(mev, mev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+#if POSCFG_ARGCHECK > 1
+  if (posInInterrupt_g != 0)
+    return -E_FORB;
+#endif
+  if (timeoutticks == 0)
+    return 1;
+
+  POS_SCHED_LOCK;
+  if ((mev->e.task != task) || (mev->e.d.counter != 0))
+  {
+    POS_SCHED_UNLOCK;
+    return -E_FAIL;
+  }
+
+  if (timeoutticks != INFINITE)
+  {
+    tasktimerticks(task) = timeoutticks;
+    pos_addToSleepList(task);
+#ifdef POS_DEBUGHELP
+    task->deb.state = task_waitingForCondvarWithTimeout;
+  }
+  else
+  {
+    task->deb.state = task_waitingForCondvar;
+#endif
+  }
+
+  /* Enter the wait list before the mutex is released,
+     so that no signal can get lost in between. */
+  pos_disableTask(task);
+  pos_eventAddTask(ev, task);
+  pos_mutexUnlock(mev);
+  pos_schedule();
+
+  if (timeoutticks != INFINITE)
+  {
+    if (task->prev == task)
+    {
+      if (pos_isTableBitSet(&ev->e.pend, task))
+      {
+        pos_eventRemoveTask(ev, task);
+        rc = 1;
+      }
+    }
+    else
+    {
+      pos_removeFromSleepList(task);
+      cleartimerticks(task);
+    }
+  }
+
+  pos_mutexLock(mev, task);
+  POS_SCHED_UNLOCK;
+  return rc;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posCondSignal(POSCOND_t cond)
+{
+  register EVENT_t  ev = (EVENT_t) cond;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posCondSignal: condition variable valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posCondSignal: condition variable allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  POS_SCHED_LOCK;
+  (void) pos_sched_event(ev);
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posCondBroadcast(POSCOND_t cond)
+{
+  register EVENT_t  ev = (EVENT_t) cond;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posCondBroadcast: condition variable valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posCondBroadcast: condition variable allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  POS_SCHED_LOCK;
+  if (!pos_tableEmpty(&ev->e.pend))
+  {
+    pos_eventWakeAll(ev);
+    posMustSchedule_g = 1;
+    pos_schedule();
+  }
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+#endif  /* POSCFG_FEATURE_CONDVARS */
+
+
+
+/*---------------------------------------------------------------------------
+ * EXPORTED FUNCTIONS:  READER/WRITER LOCKS
+ *-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_RWLOCKS != 0
+
+/*
+ * The lock is made of two events. The counter of the first one holds
+ * the state of the lock (0 = free, > 0 = count of readers, -1 = locked
+ * for writing), its pend table the waiting readers. The pend table of
+ * the second event holds the waiting writers. A writer gets the lock
+ * handed over, readers test the state again after they were woken up.
+ */
+
+POSRWLOCK_t POSCALL posRwLockCreate(void)
 {
+  register EVENT_t ev, wev;
+
+  ev = (EVENT_t) posSemaCreate(0);
+  if (ev == NULL)
+    return NULL;
+  wev = (EVENT_t) posSemaCreate(0);
+  if (wev == NULL)
+  {
+    posSemaDestroy((POSSEMA_t) ev);
+    return NULL;
+  }
+  ev->e.writers = wev;
 #ifdef POS_DEBUGHELP
-  EVENT_t ev = (EVENT_t) posSemaCreate(1);
-  if (ev != NULL) ev->e.deb.type = event_mutex;
-  return (POSMUTEX_t) ev;
-#else
-  return (POSMUTEX_t) posSemaCreate(1);
+  ev->e.deb.type  = event_rwlock;
+  wev->e.deb.type = event_rwlock;
 #endif
+  return (POSRWLOCK_t) ev;
 }
 
 /*-------------------------------------------------------------------------*/
 
-#if POSCFG_FEATURE_MUTEXDESTROY != 0
-
-void POSCALL posMutexDestroy(POSMUTEX_t mutex)
+void POSCALL posRwLockDestroy(POSRWLOCK_t rwlock)
 {
-  P_ASSERT("posMutexDestroy: mutex valid", mutex != NULL);
-  posSemaDestroy((POSSEMA_t) mutex);
-}
+  register EVENT_t ev = (EVENT_t) rwlock;
 
-#endif  /* POSCFG_FEATURE_MUTEXDESTROY */
+  P_ASSERT("posRwLockDestroy: lock valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posRwLockDestroy: lock allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  POS_ARGCHECK(ev, ev->e.magic, POSMAGIC_EVENTU); 
+  if ((ev->e.d.counter == 0) && pos_tableEmpty(&ev->e.pend) &&
+      pos_tableEmpty(&ev->e.writers->e.pend))
+  {
+    posSemaDestroy((POSSEMA_t) ev->e.writers);
+    posSemaDestroy((POSSEMA_t) ev);
+  }
+}
 
 /*-------------------------------------------------------------------------*/
 
-#if POSCFG_FEATURE_MUTEXTRYLOCK != 0
-
-VAR_t POSCALL posMutexTryLock(POSMUTEX_t mutex)
+VAR_t POSCALL posRwLockReadLock(POSRWLOCK_t rwlock)
 {
-  register EVENT_t  ev = (EVENT_t) mutex;
+  register EVENT_t  ev = (EVENT_t) rwlock;
   register POSTASK_t task = posCurrentTask_g;
   POS_LOCKFLAGS;
 
-  P_ASSERT("posMutexTryLock: mutex valid", ev != NULL);
+  P_ASSERT("posRwLockReadLock: lock valid", ev != NULL);
 #if POSCFG_ARGCHECK > 1
-  P_ASSERT("posMutexTryLock: mutex allocated",
+  P_ASSERT("posRwLockReadLock: lock allocated",
            ev->e.magic == POSMAGIC_EVENTU);
 #endif
+  P_ASSERT("posRwLockReadLock: not in an interrupt", posInInterrupt_g == 0);
   POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
   POS_SCHED_LOCK;
 
-  if (ev->e.task == task)
+  while ((ev->e.d.counter < 0) || !pos_tableEmpty(&ev->e.writers->e.pend))
   {
-    --(ev->e.d.counter);
+    pos_disableTask(task);
+    pos_eventAddTask(ev, task);
 #ifdef POS_DEBUGHELP
-    ev->e.deb.counter = ev->e.d.counter;
+    task->deb.state = task_waitingForRwLock;
 #endif
+    pos_schedule();
   }
-  else
-  {
-    if (ev->e.d.counter < 1)
-    {
-      POS_SCHED_UNLOCK;
-      return 1;  /* no lock */
-    }
-    ev->e.d.counter = 0;
-    ev->e.task = task;
+  ++(ev->e.d.counter);
 #ifdef POS_DEBUGHELP
-    ev->e.deb.counter = 0;
+  ev->e.deb.counter = ev->e.d.counter;
 #endif
-  }
   POS_SCHED_UNLOCK;
-  return 0;  /* have lock */
+  return E_OK;
 }
 
-#endif  /* POSCFG_FEATURE_MUTEXTRYLOCK */
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posRwLockReadUnlock(POSRWLOCK_t rwlock)
+{
+  register EVENT_t  ev = (EVENT_t) rwlock;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posRwLockReadUnlock: lock valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posRwLockReadUnlock: lock allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  POS_SCHED_LOCK;
+
+  if (ev->e.d.counter <= 0)
+  {
+    POS_SCHED_UNLOCK;
+    return -E_FAIL;
+  }
+  --(ev->e.d.counter);
+  if ((ev->e.d.counter == 0) && !pos_tableEmpty(&ev->e.writers->e.pend))
+  {
+    /* the last reader hands the lock over to a waiting writer */
+    ev->e.d.counter = -1;
+  }
+#ifdef POS_DEBUGHELP
+  ev->e.deb.counter = ev->e.d.counter;
+#endif
+  if (ev->e.d.counter < 0)
+    pos_sched_event(ev->e.writers);
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
 
 /*-------------------------------------------------------------------------*/
 
-VAR_t POSCALL posMutexLock(POSMUTEX_t mutex)
+VAR_t POSCALL posRwLockWriteLock(POSRWLOCK_t rwlock)
 {
-  register EVENT_t  ev = (EVENT_t) mutex;
+  register EVENT_t  ev = (EVENT_t) rwlock;
+  register EVENT_t  wev;
   register POSTASK_t task = posCurrentTask_g;
   POS_LOCKFLAGS;
 
-  P_ASSERT("posMutexLock: mutex valid", ev != NULL);
+  P_ASSERT("posRwLockWriteLock: lock valid", ev != NULL);
 #if POSCFG_ARGCHECK > 1
-  P_ASSERT("posMutexLock: mutex allocated",
+  P_ASSERT("posRwLockWriteLock: lock allocated",
            ev->e.magic == POSMAGIC_EVENTU);
 #endif
-  P_ASSERT("posMutexLock: not in an interrupt", posInInterrupt_g == 0);
+  P_ASSERT("posRwLockWriteLock: not in an interrupt", posInInterrupt_g == 0);
   POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
   POS_SCHED_LOCK;
 
-  if (ev->e.task == task)
+  if (ev->e.d.counter == 0)
   {
-    --(ev->e.d.counter);
+    ev->e.d.counter = -1;
 #ifdef POS_DEBUGHELP
-    ev->e.deb.counter = ev->e.d.counter;
+    ev->e.deb.counter = -1;
 #endif
   }
   else
   {
-    if (ev->e.d.counter > 0)
-    {
-      ev->e.d.counter = 0;
-#ifdef POS_DEBUGHELP
-      ev->e.deb.counter = 0;
-#endif
-    }
-    else
-    {
-      pos_disableTask(task);
-      pos_eventAddTask(ev, task);
+    /* the lock is handed over to us by the unlock functions */
+    wev = ev->e.writers;
+    pos_disableTask(task);
+    pos_eventAddTask(wev, task);
 #ifdef POS_DEBUGHELP
-      task->deb.state = task_waitingForMutex;
+    task->deb.state = task_waitingForRwLock;
 #endif
-      pos_schedule();
-    }
-    ev->e.task = task;
+    pos_schedule();
   }
   POS_SCHED_UNLOCK;
   return E_OK;
@@ -2155,42 +4290,48 @@ VAR_t POSCALL posMutexLock(POSMUTEX_t mutex)
 
 /*-------------------------------------------------------------------------*/
 
-VAR_t POSCALL posMutexUnlock(POSMUTEX_t mutex)
+VAR_t POSCALL posRwLockWriteUnlock(POSRWLOCK_t rwlock)
 {
-  register EVENT_t  ev = (EVENT_t) mutex;
+  register EVENT_t  ev = (EVENT_t) rwlock;
   POS_LOCKFLAGS;
 
-  P_ASSERT("posMutexUnlock: mutex valid", ev != NULL);
+  P_ASSERT("posRwLockWriteUnlock: lock valid", ev != NULL);
 #if POSCFG_ARGCHECK > 1
-  P_ASSERT("posMutexUnlock: mutex allocated",
+  P_ASSERT("posRwLockWriteUnlock: lock allocated",
            ev->e.magic == POSMAGIC_EVENTU);
 #endif
   POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
   POS_SCHED_LOCK;
 
-  if (ev->e.d.counter == 0)
+  if (ev->e.d.counter != -1)
   {
-    ev->e.task = NULL;
-    if (pos_sched_event(ev) == 0)
-    {
-      ev->e.d.counter = 1;
-#ifdef POS_DEBUGHELP
-      ev->e.deb.counter = 1;
-#endif
-    }
+    POS_SCHED_UNLOCK;
+    return -E_FAIL;
+  }
+
+  /* writers first, else let all readers in at once */
+  if (!pos_tableEmpty(&ev->e.writers->e.pend))
+  {
+    pos_sched_event(ev->e.writers);
   }
   else
   {
-    ++(ev->e.d.counter);
+    ev->e.d.counter = 0;
 #ifdef POS_DEBUGHELP
-    ev->e.deb.counter = ev->e.d.counter;
+    ev->e.deb.counter = 0;
 #endif
+    if (!pos_tableEmpty(&ev->e.pend))
+    {
+      pos_eventWakeAll(ev);
+      posMustSchedule_g = 1;
+      pos_schedule();
+    }
   }
   POS_SCHED_UNLOCK;
   return E_OK;
 }
 
-#endif  /* POSCFG_FEATURE_MUTEXES */
+#endif  /* POSCFG_FEATURE_RWLOCKS */
 
 
 
@@ -2200,12 +4341,9 @@ VAR_t POSCALL posMutexUnlock(POSMUTEX_t mutex)
 
 #if POSCFG_FEATURE_MSGBOXES != 0
 
-#if POSCFG_MSG_MEMORY == 0
-static MSGBUF_t* POSCALL pos_msgAlloc(void)
-#else
-void* POSCALL posMessageAlloc(void)
-#endif
+static MSGBUF_t* POSCALL pos_msgAlloc(UVAR_t sclass)
 {
+  register MSGCLASS_t *mc = &posMsgClass_g[sclass];
   register MSGBUF_t *mbuf;
   POS_LOCKFLAGS;
 
@@ -2218,105 +4356,189 @@ void* POSCALL posMessageAlloc(void)
 #if POSCFG_ISR_INTERRUPTABLE != 0
     POS_SCHED_LOCK;
 #endif
-    mbuf = posFreeMessagebuf_g;
+    mbuf = mc->freebuf;
     if (mbuf != NULL)
     {
-      posFreeMessagebuf_g = (MSGBUF_t*) mbuf->next;
+      mc->freebuf = (MSGBUF_t*) mbuf->next;
     }
 #if POSCFG_ISR_INTERRUPTABLE != 0
     POS_SCHED_UNLOCK;
 #endif
-#if POSCFG_MSG_MEMORY == 0
     return mbuf;
-#else
-    return (void*) mbuf;
-#endif
   }
 
 #if SYS_POSTALLOCATE != 0
   POS_SCHED_LOCK;
-  mbuf = posFreeMessagebuf_g;
+  mbuf = mc->freebuf;
   if (mbuf != NULL)
   {
-    posFreeMessagebuf_g = (MSGBUF_t*) mbuf->next;
+    mc->freebuf = (MSGBUF_t*) mbuf->next;
     POS_SCHED_UNLOCK;
-#if POSCFG_MSG_MEMORY == 0
     return mbuf;
-#else
-    return (void*) mbuf;
-#endif
   }
   POS_SCHED_UNLOCK;
+#if POSCFG_MSG_SIZECLASSES > 1
+  mbuf = (MSGBUF_t*) POS_MEM_ALLOC(MSGBLOCKSIZE(posMsgClassSize_g[sclass]) +
+                                   (POSCFG_ALIGNMENT - 1));
+#else
   mbuf = (MSGBUF_t*) POS_MEM_ALLOC(sizeof(MSGBUF_t) +
                                    (POSCFG_ALIGNMENT - 1));
+#endif
   if (mbuf != NULL)
   {
     mbuf = MEMALIGN(MSGBUF_t*, mbuf);
 #if POSCFG_ARGCHECK > 1
     mbuf->magic = POSMAGIC_MSGBUF;
 #endif
-#if POSCFG_MSG_MEMORY == 0
-    return mbuf;
-#else
-    return (void*) mbuf;
+#if POSCFG_MSG_SIZECLASSES > 1
+    mbuf->sclass = sclass;
 #endif
+    return mbuf;
   }
 #endif /* SYS_POSTALLOCATE */
 
-  posSemaGet(msgAllocSyncSem_g);
+  posSemaGet(mc->allocsync);
   POS_SCHED_LOCK;
-  mbuf = posFreeMessagebuf_g;
+  mbuf = mc->freebuf;
   while (mbuf == NULL)
   {
-    msgAllocWaitReq_g = 1;
+    mc->waitreq = 1;
     POS_SCHED_UNLOCK;
-    posSemaGet(msgAllocWaitSem_g);
+    posSemaGet(mc->allocwait);
     POS_SCHED_LOCK;
-    mbuf = posFreeMessagebuf_g;
+    mbuf = mc->freebuf;
   }
-  posFreeMessagebuf_g = (MSGBUF_t*) mbuf->next;
+  mc->freebuf = (MSGBUF_t*) mbuf->next;
   POS_SCHED_UNLOCK;
-  posSemaSignal(msgAllocSyncSem_g);
-#if POSCFG_MSG_MEMORY == 0
+  posSemaSignal(mc->allocsync);
   return mbuf;
-#else
-  return (void*) mbuf;
-#endif
 }
 
 /*-------------------------------------------------------------------------*/
 
-#if POSCFG_MSG_MEMORY == 0
 static void POSCALL pos_msgFree(MSGBUF_t *mbuf)
 {
+  register MSGCLASS_t *mc = MSGBUF_CLASS(mbuf);
   POS_LOCKFLAGS;
-  P_ASSERT("posMessageFree: buffer valid", mbuf != NULL);
+
+  POS_SCHED_LOCK;
+  mbuf->next = (void*) mc->freebuf;
+  mc->freebuf = mbuf;
+  if (mc->waitreq != 0)
+  {
+    mc->waitreq = 0;
+    POS_SCHED_UNLOCK;
+    posSemaSignal(mc->allocwait);
+    return;
+  }
+  POS_SCHED_UNLOCK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_MSG_MEMORY != 0
+
+void* POSCALL posMessageAlloc(void)
+{
+  register MSGBUF_t *mbuf;
+
+  mbuf = pos_msgAlloc(0);
+  return (mbuf != NULL) ? MSGBUF_DATA(mbuf) : NULL;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void* POSCALL posMessageAllocSize(UINT_t size)
+{
+  register MSGBUF_t *mbuf;
+#if POSCFG_MSG_SIZECLASSES > 1
+  register UVAR_t c;
+
+  for (c = 0; posMsgClassSize_g[c] < size; ++c)
+  {
+    if (c == (POSCFG_MSG_SIZECLASSES - 1))
+      return NULL;
+  }
+  mbuf = pos_msgAlloc(c);
 #else
+  if (size > POSCFG_MSG_BUFSIZE)
+    return NULL;
+  mbuf = pos_msgAlloc(0);
+#endif
+  return (mbuf != NULL) ? MSGBUF_DATA(mbuf) : NULL;
+}
+
+/*-------------------------------------------------------------------------*/
+
 void POSCALL posMessageFree(void *buf)
 {
-  MSGBUF_t *mbuf = (MSGBUF_t*) buf;
-  POS_LOCKFLAGS;
   P_ASSERT("posMessageFree: buffer valid", buf != NULL);
-  POS_ARGCHECK(mbuf, mbuf->magic, POSMAGIC_MSGBUF); 
+  POS_ARGCHECK(buf, MSGBUF_HEADER(buf)->magic, POSMAGIC_MSGBUF);
+  pos_msgFree(MSGBUF_HEADER(buf));
+}
+
+#endif  /* POSCFG_MSG_MEMORY */
+
+/*-------------------------------------------------------------------------*/
+
+/* Wake a task that waits for a new message in its message box.
+ * Must be called with the scheduler locked.
+ */
+static void POSCALL pos_msgWakeReceiver(POSTASK_t taskhandle);
+static void POSCALL pos_msgWakeReceiver(POSTASK_t taskhandle)
+{
+  taskhandle->msgwait = 0;
+  pos_sched_event((EVENT_t)taskhandle->msgsem);
+
+#if (POSCFG_SOFT_MTASK !=0)&&(SYS_TASKTABSIZE_Y >1)&&(POSCFG_ROUNDROBIN !=0)
+  if ((posMustSchedule_g != 0) &&
+      (taskhandle->idx_y >= posCurrentTask_g->idx_y))
+  {
+#ifdef POS_DEBUGHELP
+    posCurrentTask_g->deb.state = task_suspended;
 #endif
-  POS_SCHED_LOCK;
-  mbuf->next = (void*) posFreeMessagebuf_g;
-  posFreeMessagebuf_g = mbuf;
-  if (msgAllocWaitReq_g != 0)
+    pos_schedule();
+  }
+#else
+#ifdef POS_DEBUGHELP
+  posCurrentTask_g->deb.state = task_suspended;
+#endif
+  pos_schedule();
+#endif
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+
+VAR_t POSCALL posMessageSend(void *buf, POSTASK_t taskhandle)
+{
+  register VAR_t status;
+
+  status = posMessageSendWait(buf, taskhandle, 0);
+  if (status > 0)
   {
-    msgAllocWaitReq_g = 0;
-    POS_SCHED_UNLOCK;
-    posSemaSignal(msgAllocWaitSem_g);
-    return;
+#if POSCFG_MSG_MEMORY != 0
+    posMessageFree(buf);
+#endif
+    return -E_NOMORE;
   }
-  POS_SCHED_UNLOCK;
+  return status;
 }
 
 /*-------------------------------------------------------------------------*/
 
+VAR_t POSCALL posMessageSendWait(void *buf, POSTASK_t taskhandle,
+                                 UINT_t timeoutticks)
+#else
 VAR_t POSCALL posMessageSend(void *buf, POSTASK_t taskhandle)
+#endif
 {
   register MSGBUF_t *mbuf;
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+  register POSTASK_t task = posCurrentTask_g;
+  register EVENT_t ev;
+#endif
   POS_LOCKFLAGS;
 
 #if POSCFG_ARGCHECK != 0
@@ -2338,27 +4560,101 @@ VAR_t POSCALL posMessageSend(void *buf, POSTASK_t taskhandle)
 #endif
 
 #if POSCFG_MSG_MEMORY == 0
-  mbuf = pos_msgAlloc();
+  mbuf = pos_msgAlloc(0);
   if (mbuf == NULL)
     return -E_NOMEM;
   mbuf->bufptr = buf;
 #else
-  mbuf = (MSGBUF_t*) buf;
-  POS_ARGCHECK_RET(mbuf, mbuf->magic, POSMAGIC_MSGBUF, -E_ARG); 
+  POS_ARGCHECK_RET(buf, MSGBUF_HEADER(buf)->magic, POSMAGIC_MSGBUF, -E_ARG); 
+  mbuf = MSGBUF_HEADER(buf);
 #endif
 
   POS_SCHED_LOCK;
 #if POSCFG_FEATURE_EXIT != 0
-  if (taskhandle->state != POSTASKSTATE_ACTIVE)
-  {
-    POS_SCHED_UNLOCK;
+  if (taskhandle->state != POSTASKSTATE_ACTIVE)
+  {
+    POS_SCHED_UNLOCK;
+#if POSCFG_MSG_MEMORY != 0
+    posMessageFree(buf);
+#else
+    pos_msgFree(mbuf);
+#endif
+    return -E_FAIL;
+  }
+#endif
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+  if ((taskhandle->msglimit != 0) &&
+      (taskhandle->msgcount >= taskhandle->msglimit))
+  {
+    if ((timeoutticks != 0) && (posInInterrupt_g == 0))
+    {
+      if (timeoutticks != INFINITE)
+      {
+        tasktimerticks(task) = timeoutticks;
+        pos_addToSleepList(task);
+#ifdef POS_DEBUGHELP
+        task->deb.state = task_waitingForMsgSpaceWithTimeout;
+      }
+      else
+      {
+        task->deb.state = task_waitingForMsgSpace;
+#endif
+      }
+
+#if POSCFG_FEATURE_EXIT != 0
+      task->msgsendexit = 0;
+#endif
+      do
+      {
+        ev = (EVENT_t) taskhandle->msgsendsem;
+        pos_disableTask(task);
+        pos_eventAddTask(ev, task);
+        pos_schedule();
+#if POSCFG_FEATURE_EXIT != 0
+        /* the receiver has exited, its task handle may be reused */
+        if (task->msgsendexit != 0)
+          break;
+#endif
+        if ((timeoutticks != INFINITE) && (task->prev == task))
+        {
+          if (pos_isTableBitSet(&ev->e.pend, task))
+            pos_eventRemoveTask(ev, task);
+          break;
+        }
+      }
+      while ((taskhandle->msglimit != 0) &&
+             (taskhandle->msgcount >= taskhandle->msglimit));
+
+      if ((timeoutticks != INFINITE) && (task->prev != task))
+      {
+        pos_removeFromSleepList(task);
+        cleartimerticks(task);
+      }
+#if POSCFG_FEATURE_EXIT != 0
+      if (task->msgsendexit != 0)
+      {
+        POS_SCHED_UNLOCK;
 #if POSCFG_MSG_MEMORY != 0
-    posMessageFree(buf);
+        posMessageFree(buf);
 #else
-    pos_msgFree(mbuf);
+        pos_msgFree(mbuf);
 #endif
-    return -E_FAIL;
+        return -E_FAIL;
+      }
+#endif
+    }
+    if ((taskhandle->msglimit != 0) &&
+        (taskhandle->msgcount >= taskhandle->msglimit))
+    {
+      POS_SCHED_UNLOCK;
+#if POSCFG_MSG_MEMORY == 0
+      pos_msgFree(mbuf);
+#endif
+      return 1;
+    }
   }
+  if (++(taskhandle->msgcount) > taskhandle->msghwm)
+    taskhandle->msghwm = taskhandle->msgcount;
 #endif
   mbuf->next = NULL;
   if (taskhandle->lastmsg == NULL)
@@ -2373,24 +4669,7 @@ VAR_t POSCALL posMessageSend(void *buf, POSTASK_t taskhandle)
   }
   if (taskhandle->msgwait != 0)
   {
-    taskhandle->msgwait = 0;
-    pos_sched_event((EVENT_t)taskhandle->msgsem);
-
-#if (POSCFG_SOFT_MTASK !=0)&&(SYS_TASKTABSIZE_Y >1)&&(POSCFG_ROUNDROBIN !=0)
-    if ((posMustSchedule_g != 0) &&
-        (taskhandle->idx_y >= posCurrentTask_g->idx_y))
-    {
-#ifdef POS_DEBUGHELP
-      posCurrentTask_g->deb.state = task_suspended;
-#endif
-      pos_schedule();
-    }
-#else
-#ifdef POS_DEBUGHELP
-    posCurrentTask_g->deb.state = task_suspended;
-#endif
-    pos_schedule();
-#endif
+    pos_msgWakeReceiver(taskhandle);
   }
   POS_SCHED_UNLOCK;
   return E_OK;
@@ -2449,6 +4728,11 @@ void* POSCALL posMessageGet(void)
   {
     task->lastmsg = NULL;
   }
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+  --(task->msgcount);
+  if (task->msgsendsem != NULL)
+    pos_sched_event((EVENT_t) task->msgsendsem);
+#endif
   POS_SCHED_UNLOCK;
 
 #if POSCFG_MSG_MEMORY == 0
@@ -2456,7 +4740,7 @@ void* POSCALL posMessageGet(void)
   pos_msgFree(mbuf);
   return buf;
 #else
-  return (void*) (mbuf->buffer);
+  return MSGBUF_DATA(mbuf);
 #endif
 }
 #endif
@@ -2528,8 +4812,8 @@ void* POSCALL posMessageWait(UINT_t timeoutticks)
     if ((timeoutticks != INFINITE) &&
         (task->prev != task))
     {
-      cleartimerticks(task);
       pos_removeFromSleepList(task);
+      cleartimerticks(task);
     }
   }
 
@@ -2540,13 +4824,18 @@ void* POSCALL posMessageWait(UINT_t timeoutticks)
     {
       task->lastmsg = NULL;
     }
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+    --(task->msgcount);
+    if (task->msgsendsem != NULL)
+      pos_sched_event((EVENT_t) task->msgsendsem);
+#endif
     POS_SCHED_UNLOCK;
 #if POSCFG_MSG_MEMORY == 0
     buf = mbuf->bufptr;
     pos_msgFree(mbuf);
     return buf;
 #else
-    return (void*) (mbuf->buffer);
+    return MSGBUF_DATA(mbuf);
 #endif
   }
 
@@ -2563,6 +4852,241 @@ VAR_t POSCALL posMessageAvailable(void)
   return (posCurrentTask_g->firstmsg != NULL) ? 1 : 0;
 }
 
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+
+VAR_t POSCALL posMessageBoxLimit(UINT_t limit)
+{
+  register POSTASK_t task = posCurrentTask_g;
+  register POSSEMA_t sem;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posMessageBoxLimit: not in an interrupt", posInInterrupt_g == 0);
+  if ((limit != 0) && (task->msgsendsem == NULL))
+  {
+    sem = posSemaCreate(0);
+    if (sem == NULL)
+      return -E_NOMEM;
+    POS_SETEVENTNAME(sem, "taskMsgSendSem");
+    task->msgsendsem = sem;
+  }
+  POS_SCHED_LOCK;
+  task->msglimit = limit;
+  if (task->msgsendsem != NULL)
+  {
+    /* let the waiting senders check the new limit */
+    pos_eventWakeAll((EVENT_t) task->msgsendsem);
+    posMustSchedule_g = 1;
+    pos_schedule();
+  }
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+UINT_t POSCALL posMessageHighWater(POSTASK_t taskhandle)
+{
+  P_ASSERT("posMessageHighWater: task valid", taskhandle != NULL);
+  POS_ARGCHECK_RET(taskhandle, taskhandle->magic, POSMAGIC_TASK, 0);
+  return taskhandle->msghwm;
+}
+
+#endif  /* POSCFG_FEATURE_MSGBOXLIMIT */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_MSGBATCH != 0
+
+VAR_t POSCALL posMessageSendBatch(void **bufs, UINT_t count,
+                                  POSTASK_t taskhandle)
+{
+  register MSGBUF_t *first, *last;
+  register UINT_t i;
+  register VAR_t status;
+  POS_LOCKFLAGS;
+
+#if POSCFG_ARGCHECK != 0
+  if ((taskhandle == NULL)
+#if POSCFG_ARGCHECK > 1
+      || (taskhandle->magic != POSMAGIC_TASK)
+#endif
+     )
+  {
+    for (i = 0; i < count; ++i)
+      posMessageFree(bufs[i]);
+    P_ASSERT("posMessageSendBatch: arguments valid", 0);
+    return -E_ARG;
+  }
+  for (i = 0; i < count; ++i)
+  {
+    POS_ARGCHECK_RET(bufs[i], MSGBUF_HEADER(bufs[i])->magic,
+                     POSMAGIC_MSGBUF, -E_ARG); 
+  }
+#endif
+  if (count == 0)
+    return E_OK;
+
+  /* link the chain before the scheduler is locked */
+  first = MSGBUF_HEADER(bufs[0]);
+  last = first;
+  for (i = 1; i < count; ++i)
+  {
+    last->next = MSGBUF_HEADER(bufs[i]);
+    last = last->next;
+  }
+  last->next = NULL;
+
+  POS_SCHED_LOCK;
+#if POSCFG_FEATURE_EXIT != 0
+  if (taskhandle->state != POSTASKSTATE_ACTIVE)
+  {
+    status = -E_FAIL;
+  }
+  else
+#endif
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+  if ((taskhandle->msglimit != 0) &&
+      ((taskhandle->msgcount + count) > taskhandle->msglimit))
+  {
+    status = -E_NOMORE;
+  }
+  else
+#endif
+  {
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+    taskhandle->msgcount += count;
+    if (taskhandle->msgcount > taskhandle->msghwm)
+      taskhandle->msghwm = taskhandle->msgcount;
+#endif
+    if (taskhandle->lastmsg == NULL)
+    {
+      taskhandle->firstmsg = (void*) first;
+    }
+    else
+    {
+      ((MSGBUF_t*)(taskhandle->lastmsg))->next = first;
+    }
+    taskhandle->lastmsg = (void*) last;
+    if (taskhandle->msgwait != 0)
+    {
+      pos_msgWakeReceiver(taskhandle);
+    }
+    status = E_OK;
+  }
+  POS_SCHED_UNLOCK;
+
+  if (status != E_OK)
+  {
+    for (i = 0; i < count; ++i)
+      posMessageFree(bufs[i]);
+  }
+  return status;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void* POSCALL posMessageWaitAll(UINT_t timeoutticks)
+{
+  register POSTASK_t task = posCurrentTask_g;
+  register MSGBUF_t *mbuf;
+  register POSSEMA_t sem;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posMessageWaitAll: not in an interrupt", posInInterrupt_g == 0);
+#if POSCFG_ARGCHECK > 1
+  if (posInInterrupt_g != 0)
+    return NULL;
+#endif
+
+  if (task->msgsem == NULL)
+  {
+    sem = posSemaCreate(0);
+    if (sem == NULL)
+    {
+      return NULL;
+    }
+    POS_SETEVENTNAME(sem, "taskMessageSem");
+    POS_SCHED_LOCK;
+    task->msgsem = sem;
+  }
+  else
+  {
+    POS_SCHED_LOCK;
+  }
+
+  if ((timeoutticks != 0) && (task->firstmsg == NULL))
+  {
+    if (timeoutticks != INFINITE)
+    {
+      tasktimerticks(task) = timeoutticks;
+      pos_addToSleepList(task);
+#ifdef POS_DEBUGHELP
+      task->deb.state = task_waitingForMessageWithTimeout;
+    }
+    else
+    {
+      task->deb.state = task_waitingForMessage;
+#endif
+    }
+
+    task->msgwait = 1;
+    pos_disableTask(task);
+    pos_eventAddTask((EVENT_t)task->msgsem, task);
+    pos_schedule();
+
+    if (task->msgwait != 0)
+    {
+      pos_eventRemoveTask((EVENT_t)task->msgsem, task);
+      task->msgwait = 0;
+    }
+    if ((timeoutticks != INFINITE) &&
+        (task->prev != task))
+    {
+      pos_removeFromSleepList(task);
+      cleartimerticks(task);
+    }
+  }
+
+  /* detach the whole chain */
+  mbuf = (MSGBUF_t*) (task->firstmsg);
+  task->firstmsg = NULL;
+  task->lastmsg = NULL;
+#if POSCFG_FEATURE_MSGBOXLIMIT != 0
+  task->msgcount = 0;
+  if ((mbuf != NULL) && (task->msgsendsem != NULL))
+  {
+    pos_eventWakeAll((EVENT_t) task->msgsendsem);
+    posMustSchedule_g = 1;
+    pos_schedule();
+  }
+#endif
+  POS_SCHED_UNLOCK;
+  return (mbuf != NULL) ? MSGBUF_DATA(mbuf) : NULL;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void* POSCALL posMessageGetAll(void)
+{
+  return posMessageWaitAll(INFINITE);
+}
+
+/*-------------------------------------------------------------------------*/
+
+void* POSCALL posMessageNext(void *buf)
+{
+  register MSGBUF_t *mbuf;
+
+  P_ASSERT("posMessageNext: buffer valid", buf != NULL);
+  POS_ARGCHECK_RET(buf, MSGBUF_HEADER(buf)->magic, POSMAGIC_MSGBUF, NULL);
+  mbuf = MSGBUF_HEADER(buf)->next;
+  return (mbuf != NULL) ? MSGBUF_DATA(mbuf) : NULL;
+}
+
+#endif  /* POSCFG_FEATURE_MSGBATCH */
+
 #endif  /* POSCFG_FEATURE_MSGBOXES */
 
 
@@ -2635,6 +5159,13 @@ POSTIMER_t POSCALL posTimerCreate(void)
 #endif
 #if POSCFG_FEATURE_TIMERFIRED != 0
   t->fired  = 0;
+#endif
+#if POSCFG_FEATURE_TIMERDAEMON != 0
+  t->dqueued = 0;
+#endif
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  t->hrnext  = t;
+  t->hires   = 0;
 #endif
   return (POSTIMER_t) t;
 }
@@ -2690,6 +5221,9 @@ VAR_t POSCALL posTimerSet(POSTIMER_t tmr, POSSEMA_t sema,
   t->sema   = sema;
   t->wait   = waitticks;
   t->reload = periodticks;
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  t->hires  = 0;
+#endif
   POS_SCHED_UNLOCK;
   return E_OK;
 #endif
@@ -2718,11 +5252,81 @@ VAR_t POSCALL posTimerCallbackSet(POSTIMER_t tmr, POSTIMERFUNC_t callback,
   t->callbackArg = arg;
   t->wait        = waitticks;
   t->reload      = periodticks;
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  t->hires       = 0;
+#endif
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+#endif
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_HIRESTIMER != 0
+
+VAR_t POSCALL posTimerSetNs(POSTIMER_t tmr, POSSEMA_t sema,
+                            NSEC_t waitns, NSEC_t periodns)
+{
+  register EVENT_t  ev = (EVENT_t) sema;
+  P_ASSERT("posTimerSetNs: semaphore valid", sema != NULL);
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+  return posTimerCallbackSetNs(tmr, pos_timerSemaSignal, sema,
+                               waitns, periodns);
+#else
+  register TIMER_t  *t = (TIMER_t*) tmr;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posTimerSetNs: timer valid", tmr != NULL);
+  POS_ARGCHECK_RET(t, t->magic, POSMAGIC_TIMER, -E_ARG);
+#if POSCFG_ARGCHECK > 1
+  if (waitns == 0)
+     return -E_ARG;
+#endif
+
+  posTimerStop(tmr);
+  POS_SCHED_LOCK;
+  t->sema     = sema;
+  t->hrwait   = waitns;
+  t->hrreload = periodns;
+  t->hires    = 1;
+  POS_SCHED_UNLOCK;
+  return E_OK;
+#endif
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+VAR_t POSCALL posTimerCallbackSetNs(POSTIMER_t tmr, POSTIMERFUNC_t callback,
+                                    void* arg, NSEC_t waitns, NSEC_t periodns)
+{
+  register TIMER_t  *t = (TIMER_t*) tmr;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posTimerSetNs: timer valid", tmr != NULL);
+  P_ASSERT("posTimerSetNs: callback valid", callback != NULL);
+  POS_ARGCHECK_RET(t, t->magic, POSMAGIC_TIMER, -E_ARG); 
+#if POSCFG_ARGCHECK > 1
+  if (waitns == 0)
+     return -E_ARG;
+#endif
+
+  posTimerStop(tmr);
+  POS_SCHED_LOCK;
+  t->callback    = callback;
+  t->callbackArg = arg;
+  t->hrwait      = waitns;
+  t->hrreload    = periodns;
+  t->hires       = 1;
   POS_SCHED_UNLOCK;
   return E_OK;
 }
 #endif
 
+#endif  /* POSCFG_FEATURE_HIRESTIMER */
+
 /*-------------------------------------------------------------------------*/
 
 VAR_t POSCALL posTimerStart(POSTIMER_t tmr)
@@ -2733,14 +5337,39 @@ VAR_t POSCALL posTimerStart(POSTIMER_t tmr)
   P_ASSERT("posTimerStart: timer valid", tmr != NULL);
   POS_ARGCHECK_RET(t, t->magic, POSMAGIC_TIMER, -E_ARG); 
   POS_SCHED_LOCK;
-  t->counter = t->wait;
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  if (t->hires != 0)
+  {
+    if (t->hrnext == t)
+    {
+#if POSCFG_FEATURE_TIMERFIRED != 0
+      t->fired = 0;
+#endif
+    }
+    else
+    {
+      pos_hiresRemoveTimer(t);
+    }
+    t->hrexpiry = p_pos_hiresNow() + t->hrwait;
+    pos_hiresAddTimer(t);
+    if (posHiresTimers_g == t)
+      pos_hiresProgram();
+    POS_SCHED_UNLOCK;
+    return E_OK;
+  }
+#endif
   if (t->prev == t)
   {
 #if POSCFG_FEATURE_TIMERFIRED != 0
     t->fired = 0;
 #endif
-    pos_addToTimerList(t);
   }
+  else
+  {
+    pos_removeFromTimerList(t);
+  }
+  t->counter = t->wait;
+  pos_addToTimerList(t);
   POS_SCHED_UNLOCK;
   return E_OK;
 }
@@ -2759,6 +5388,18 @@ VAR_t POSCALL posTimerStop(POSTIMER_t tmr)
   {
     pos_removeFromTimerList(t);
   }
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  if (t->hrnext != t)
+  {
+    pos_hiresRemoveTimer(t);
+  }
+#endif
+#if POSCFG_FEATURE_TIMERDAEMON != 0
+  if (t->dqueued != 0)
+  {
+    pos_timerUnqueue(t);
+  }
+#endif
   POS_SCHED_UNLOCK;
   return E_OK;
 }
@@ -2784,6 +5425,55 @@ VAR_t POSCALL posTimerFired(POSTIMER_t tmr)
 
 #endif  /* POSCFG_FEATURE_TIMERFIRED */
 
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_TIMERDAEMON != 0
+
+void posTimerDaemon(void *arg)
+{
+  register TIMER_t *t;
+  register POSSEMA_t sema;
+  POSTIMERFUNC_t func;
+  void *farg;
+  POS_LOCKFLAGS;
+
+  (void) arg;
+  P_ASSERT("posTimerDaemon: only one daemon", posTimerDaemonSema_g == NULL);
+  if (posTimerDaemonSema_g != NULL)
+    return;
+  sema = posSemaCreate(0);
+  P_ASSERT("posTimerDaemon: semaphore created", sema != NULL);
+  if (sema == NULL)
+    return;
+  POS_SETEVENTNAME(sema, "timerDaemonSem");
+  POS_SETTASKNAME(posCurrentTask_g, "timer daemon");
+  POS_SCHED_LOCK;
+  posTimerDaemonSema_g = sema;
+  POS_SCHED_UNLOCK;
+
+  for (;;)
+  {
+    posSemaGet(sema);
+    POS_SCHED_LOCK;
+    while (posTimerDaemonHead_g != NULL)
+    {
+      t = posTimerDaemonHead_g;
+      posTimerDaemonHead_g = t->dnext;
+      if (posTimerDaemonHead_g == NULL)
+        posTimerDaemonTail_g = NULL;
+      t->dqueued = 0;
+      func = t->callback;
+      farg = t->callbackArg;
+      POS_SCHED_UNLOCK;
+      func((POSTIMER_t) t, farg);
+      POS_SCHED_LOCK;
+    }
+    POS_SCHED_UNLOCK;
+  }
+}
+
+#endif  /* POSCFG_FEATURE_TIMERDAEMON */
+
 #endif  /* POSCFG_FEATURE_TIMER */
 
 
@@ -2823,6 +5513,100 @@ void POSCALL posFlagDestroy(POSFLAG_t flg)
 
 /*-------------------------------------------------------------------------*/
 
+#if POSCFG_FEATURE_FLAGWAITMASK != 0
+
+/* Make the tasks of one row of the pend table ready whose wait
+ * condition is met by the flags. Bit 0 of the state is set when a task
+ * was woken, bit 1 when a posFlagGet / posFlagWait task was woken.
+ * These tasks take the flags themselves, so only one of them is woken.
+ */
+static UVAR_t POSCALL pos_flagWakeRow(EVENT_t ev, UVAR_t y, UVAR_t state);
+static UVAR_t POSCALL pos_flagWakeRow(EVENT_t ev, UVAR_t y, UVAR_t state)
+{
+  register POSTASK_t task;
+  register UVAR_t x, bits, m;
+
+  bits = ev->e.pend.xtable[y];
+  while ((bits != 0) && (ev->e.d.flags != 0))
+  {
+    x = POS_FINDBIT(bits);
+    bits &= ~pos_shift1l(x);
+    task = posTaskTable_g[(y * SYS_TASKTABSIZE_X) + x];
+#if POSCFG_FEATURE_EVENTWAITANY != 0
+    if (task->waitany != NULL)
+    {
+      pos_eventRemoveTask(ev, task);
+      pos_waitAnyDone(task, ev);
+    }
+    else
+#endif
+    if (task->flagmask == 0)
+    {
+      if ((state & 2) != 0)
+        continue;
+      state |= 2;
+      pos_eventRemoveTask(ev, task);
+    }
+    else
+    {
+      m = ev->e.d.flags & task->flagmask;
+      if ((task->flagmode & POSFLAG_WAIT_ALL) ?
+          (m != task->flagmask) : (m == 0))
+        continue;
+      if ((task->flagmode & POSFLAG_WAIT_CLEAR) != 0)
+        ev->e.d.flags &= ~task->flagmask;
+      task->flagmask = m;
+      pos_eventRemoveTask(ev, task);
+    }
+    pos_enableTask(task);
+    state |= 1;
+  }
+  return state;
+}
+
+/* Wake all tasks pending on a flag object whose wait condition is met,
+ * in the order of their priority. Returns nonzero if a task was woken.
+ */
+static UVAR_t POSCALL pos_flagWake(EVENT_t ev);
+static UVAR_t POSCALL pos_flagWake(EVENT_t ev)
+{
+  register UVAR_t state = 0;
+#if SYS_TASKTABSIZE_Z > 1
+  register UVAR_t z, zm, y, m;
+
+  zm = ev->e.pend.zmask;
+  while (zm != 0)
+  {
+    z = POS_FINDBIT(zm);
+    zm &= ~pos_shift1l(z);
+    m = ev->e.pend.ymask[z];
+    while (m != 0)
+    {
+      y = POS_FINDBIT(m);
+      m &= ~pos_shift1l(y);
+      state = pos_flagWakeRow(ev, (z * MVAR_BITS) + y, state);
+    }
+  }
+#elif SYS_TASKTABSIZE_Y > 1
+  register UVAR_t y, m;
+
+  m = ev->e.pend.ymask;
+  while (m != 0)
+  {
+    y = POS_FINDBIT(m);
+    m &= ~pos_shift1l(y);
+    state = pos_flagWakeRow(ev, y, state);
+  }
+#else
+  state = pos_flagWakeRow(ev, 0, state);
+#endif
+  return state & 1;
+}
+
+#endif  /* POSCFG_FEATURE_FLAGWAITMASK */
+
+/*-------------------------------------------------------------------------*/
+
 VAR_t POSCALL posFlagSet(POSFLAG_t flg, UVAR_t flgnum)
 {
   register EVENT_t  ev = (EVENT_t) flg;
@@ -2840,7 +5624,15 @@ VAR_t POSCALL posFlagSet(POSFLAG_t flg, UVAR_t flgnum)
 #endif
   POS_SCHED_LOCK;
   ev->e.d.flags |= pos_shift1l(flgnum);
+#if POSCFG_FEATURE_FLAGWAITMASK != 0
+  if (pos_flagWake(ev) != 0)
+  {
+    posMustSchedule_g = 1;
+    pos_schedule();
+  }
+#else
   pos_sched_event(ev);
+#endif
   POS_SCHED_UNLOCK;
   return E_OK;
 }
@@ -2869,94 +5661,352 @@ VAR_t POSCALL posFlagGet(POSFLAG_t flg, UVAR_t mode)
   POS_SCHED_LOCK;
   if (ev->e.d.flags == 0)
   {
+#if POSCFG_FEATURE_FLAGWAITMASK != 0
+    task->flagmask = 0;
+#endif
+    do
+    {
+      pos_disableTask(task);
+      pos_eventAddTask(ev, task);
+#ifdef POS_DEBUGHELP
+      task->deb.state = task_waitingForFlag;
+#endif
+      pos_schedule();
+    }
+    while (ev->e.d.flags == 0);
+  }
+  if (mode == POSFLAG_MODE_GETSINGLE)
+  {
+    f = POS_FINDBIT(ev->e.d.flags);
+    ev->e.d.flags &= ~pos_shift1l(f);
+  }
+  else
+  {
+    f = ev->e.d.flags;
+    ev->e.d.flags = 0;
+  }
+  POS_SCHED_UNLOCK;
+  return (VAR_t) f;
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_FLAGWAIT != 0
+
+VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks)
+{
+  register EVENT_t  ev = (EVENT_t) flg;
+  register POSTASK_t task = posCurrentTask_g;
+  register UVAR_t  f;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posFlagWait: flag valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posFlagWait: flag allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  P_ASSERT("posFlagWait: not in an interrupt", posInInterrupt_g == 0);
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  POS_SCHED_LOCK;
+
+  if ((timeoutticks != 0) && (ev->e.d.flags == 0))
+  {
+    if (timeoutticks != INFINITE)
+    {
+      tasktimerticks(task) = timeoutticks;
+      pos_addToSleepList(task);
+#ifdef POS_DEBUGHELP
+      task->deb.state = task_waitingForFlagWithTimeout;
+    }
+    else
+    {
+      task->deb.state = task_waitingForFlag;
+#endif
+    }
+#if POSCFG_FEATURE_FLAGWAITMASK != 0
+    task->flagmask = 0;
+#endif
+
     do
     {
       pos_disableTask(task);
       pos_eventAddTask(ev, task);
+      pos_schedule();
+    }
+    while ((ev->e.d.flags == 0) && 
+           ((timeoutticks == INFINITE) || (task->prev != task)));
+
+    if (timeoutticks != INFINITE)
+    {
+      pos_eventRemoveTask(ev, task);
+      if (task->prev != task)
+      {
+        pos_removeFromSleepList(task);
+        cleartimerticks(task);
+      }
+    }
+  }
+  f = ev->e.d.flags;
+  ev->e.d.flags = 0;
+  POS_SCHED_UNLOCK;
+  return (VAR_t) f;
+}
+
+#endif  /* POSCFG_FEATURE_FLAGWAIT */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_FLAGWAITMASK != 0
+
+VAR_t POSCALL posFlagWaitMask(POSFLAG_t flg, UVAR_t mask,
+                              UVAR_t mode, UINT_t timeoutticks)
+{
+  register EVENT_t  ev = (EVENT_t) flg;
+  register POSTASK_t task = posCurrentTask_g;
+  register UVAR_t  f;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posFlagWaitMask: flag valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posFlagWaitMask: flag allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  P_ASSERT("posFlagWaitMask: not in an interrupt", posInInterrupt_g == 0);
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+#if POSCFG_ARGCHECK != 0
+  if ((mask == 0) || ((mask & pos_shift1l(MVAR_BITS-1)) != 0) ||
+      (mode > (POSFLAG_WAIT_ALL | POSFLAG_WAIT_CLEAR)))
+    return -E_ARG;
+#endif
+  POS_SCHED_LOCK;
+
+  f = ev->e.d.flags & mask;
+  if (((mode & POSFLAG_WAIT_ALL) != 0) ? (f == mask) : (f != 0))
+  {
+    if ((mode & POSFLAG_WAIT_CLEAR) != 0)
+      ev->e.d.flags &= ~mask;
+  }
+  else
+  if (timeoutticks == 0)
+  {
+    f = 0;
+  }
+  else
+  {
+    if (timeoutticks != INFINITE)
+    {
+      tasktimerticks(task) = timeoutticks;
+      pos_addToSleepList(task);
+#ifdef POS_DEBUGHELP
+      task->deb.state = task_waitingForFlagWithTimeout;
+    }
+    else
+    {
+      task->deb.state = task_waitingForFlag;
+#endif
+    }
+
+    /* posFlagSet checks the condition and stores the result */
+    task->flagmask = mask;
+    task->flagmode = mode;
+    pos_disableTask(task);
+    pos_eventAddTask(ev, task);
+    pos_schedule();
+    f = task->flagmask;
+
+    if (timeoutticks != INFINITE)
+    {
+      if (task->prev == task)
+      {
+        if (pos_isTableBitSet(&ev->e.pend, task))
+        {
+          pos_eventRemoveTask(ev, task);
+          f = 0;
+        }
+      }
+      else
+      {
+        pos_removeFromSleepList(task);
+        cleartimerticks(task);
+      }
+    }
+  }
+  POS_SCHED_UNLOCK;
+  return (VAR_t) f;
+}
+
+#endif  /* POSCFG_FEATURE_FLAGWAITMASK */
+
+#endif  /* POSCFG_FEATURE_FLAGS */
+
+
+
+/*---------------------------------------------------------------------------
+ * EXPORTED FUNCTIONS:  WAIT FOR MULTIPLE EVENTS
+ *-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_EVENTWAITANY != 0
+
+/* Return the index of the first ready object, or count if none is
+ * ready. The count of a ready semaphore is taken.
+ */
+static UVAR_t POSCALL pos_waitAnyPoll(POSTASK_t task,
+                                      const POSWAITOBJ_t *objs,
+                                      UVAR_t count);
+static UVAR_t POSCALL pos_waitAnyPoll(POSTASK_t task,
+                                      const POSWAITOBJ_t *objs,
+                                      UVAR_t count)
+{
+  register EVENT_t ev;
+  register UVAR_t  i;
+
+  for (i = 0; i < count; ++i)
+  {
+#if POSCFG_FEATURE_MSGBOXES != 0
+    if (objs[i].type == POSWAIT_MSGBOX)
+    {
+      if (task->firstmsg != NULL)
+        break;
+      continue;
+    }
+#endif
+    ev = (EVENT_t) objs[i].handle;
+#if POSCFG_FEATURE_FLAGS != 0
+    if (objs[i].type == POSWAIT_FLAG)
+    {
+      if (ev->e.d.flags != 0)
+        break;
+      continue;
+    }
+#endif
+    if (ev->e.d.counter > 0)
+    {
+      --(ev->e.d.counter);
 #ifdef POS_DEBUGHELP
-      task->deb.state = task_waitingForFlag;
+      ev->e.deb.counter = ev->e.d.counter;
 #endif
-      pos_schedule();
+      break;
     }
-    while (ev->e.d.flags == 0);
-  }
-  if (mode == POSFLAG_MODE_GETSINGLE)
-  {
-    f = POS_FINDBIT(ev->e.d.flags);
-    ev->e.d.flags &= ~pos_shift1l(f);
-  }
-  else
-  {
-    f = ev->e.d.flags;
-    ev->e.d.flags = 0;
   }
-  POS_SCHED_UNLOCK;
-  return (VAR_t) f;
+  return i;
 }
 
 /*-------------------------------------------------------------------------*/
 
-#if POSCFG_FEATURE_FLAGWAIT != 0
-
-VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks)
+VAR_t POSCALL posEventWaitAny(const POSWAITOBJ_t *objs, UVAR_t count,
+                              UINT_t timeoutticks)
 {
-  register EVENT_t  ev = (EVENT_t) flg;
   register POSTASK_t task = posCurrentTask_g;
-  register UVAR_t  f;
+  register UVAR_t  i;
+#if POSCFG_FEATURE_MSGBOXES != 0
+  register POSSEMA_t sem;
+#endif
   POS_LOCKFLAGS;
 
-  P_ASSERT("posFlagWait: flag valid", ev != NULL);
+  P_ASSERT("posEventWaitAny: objects valid", (objs != NULL) && (count != 0));
+  P_ASSERT("posEventWaitAny: not in an interrupt", posInInterrupt_g == 0);
+#if POSCFG_ARGCHECK != 0
+  if ((objs == NULL) || (count == 0))
+    return -E_ARG;
+  for (i = 0; i < count; ++i)
+  {
+    if (objs[i].type == POSWAIT_MSGBOX)
+    {
+#if POSCFG_FEATURE_MSGBOXES == 0
+      return -E_ARG;
+#endif
+    }
+    else
+    {
+#if POSCFG_FEATURE_FLAGS == 0
+      if (objs[i].type != POSWAIT_SEMA)
+#else
+      if (objs[i].type > POSWAIT_FLAG)
+#endif
+        return -E_ARG;
+      POS_ARGCHECK_RET(((EVENT_t) objs[i].handle),
+                       ((EVENT_t) objs[i].handle)->e.magic,
+                       POSMAGIC_EVENTU, -E_ARG);
+    }
+  }
+#endif
 #if POSCFG_ARGCHECK > 1
-  P_ASSERT("posFlagWait: flag allocated",
-           ev->e.magic == POSMAGIC_EVENTU);
+  if (posInInterrupt_g != 0)
+    return -E_FORB;
 #endif
-  P_ASSERT("posFlagWait: not in an interrupt", posInInterrupt_g == 0);
-  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+
+#if POSCFG_FEATURE_MSGBOXES != 0
+  if (task->msgsem == NULL)
+  {
+    for (i = 0; i < count; ++i)
+    {
+      if (objs[i].type == POSWAIT_MSGBOX)
+      {
+        sem = posSemaCreate(0);
+        if (sem == NULL)
+          return -E_NOMEM;
+        POS_SETEVENTNAME(sem, "taskMessageSem");
+        task->msgsem = sem;
+        break;
+      }
+    }
+  }
+#endif
+
   POS_SCHED_LOCK;
+  i = pos_waitAnyPoll(task, objs, count);
 
-  if ((timeoutticks != 0) && (ev->e.d.flags == 0))
+  if ((i == count) && (timeoutticks != 0))
   {
     if (timeoutticks != INFINITE)
     {
       tasktimerticks(task) = timeoutticks;
       pos_addToSleepList(task);
 #ifdef POS_DEBUGHELP
-      task->deb.state = task_waitingForFlagWithTimeout;
+      task->deb.state = task_waitingForEventsWithTimeout;
     }
     else
     {
-      task->deb.state = task_waitingForFlag;
+      task->deb.state = task_waitingForEvents;
 #endif
     }
 
     do
     {
+      task->waitany = (const void*) objs;
+      task->waitanycnt = count;
+      pos_waitAnyLink(task, 1);
       pos_disableTask(task);
-      pos_eventAddTask(ev, task);
       pos_schedule();
+
+      if (task->waitany != NULL)
+      {
+        /* timeout */
+        pos_waitAnyDone(task, NULL);
+        i = pos_waitAnyPoll(task, objs, count);
+        break;
+      }
+
+      /* a semaphore was handed over to us, but flags and messages
+         may have been taken by another task in the meantime */
+      i = task->waitanyidx;
+      if (objs[i].type != POSWAIT_SEMA)
+        i = pos_waitAnyPoll(task, objs, count);
     }
-    while ((ev->e.d.flags == 0) && 
+    while ((i == count) &&
            ((timeoutticks == INFINITE) || (task->prev != task)));
 
-    if (timeoutticks != INFINITE)
+    if ((timeoutticks != INFINITE) && (task->prev != task))
     {
-      pos_eventRemoveTask(ev, task);
-      if (task->prev != task)
-      {
-        cleartimerticks(task);
-        pos_removeFromSleepList(task);
-      }
+      pos_removeFromSleepList(task);
+      cleartimerticks(task);
     }
   }
-  f = ev->e.d.flags;
-  ev->e.d.flags = 0;
   POS_SCHED_UNLOCK;
-  return (VAR_t) f;
+  return (VAR_t) i;
 }
 
-#endif  /* POSCFG_FEATURE_FLAGWAIT */
-
-#endif  /* POSCFG_FEATURE_FLAGS */
+#endif  /* POSCFG_FEATURE_EVENTWAITANY */
 
 
 
@@ -2966,9 +6016,47 @@ VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks)
 
 #if POSCFG_FEATURE_SOFTINTS != 0
 
+#if POSCFG_SOFTINT_COALESCE != 0
+
+void POSCALL posSoftInt(UVAR_t intno, UVAR_t param)
+{
+  register UVAR_t w, m;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posSoftInt: interrupt number", intno < POSCFG_SOFTINTERRUPTS);
+  if (intno < POSCFG_SOFTINTERRUPTS)
+  {
+    w = intno / MVAR_BITS;
+    m = pos_shift1l(intno & (MVAR_BITS - 1));
+    POS_IRQ_DISABLE_ALL;
+    if ((sintPending_g[w] & m) != 0)
+    {
+      /* already pending: merge into the one invocation */
+      if (sintMerge_g[intno] != NULL)
+        param = (sintMerge_g[intno])(sintParam_g[intno], param);
+    }
+    else
+    {
+      sintPending_g[w] |= m;
+      ++sintPendCount_g;
+#if POSCFG_FEATURE_SOFTINTSTATS != 0
+      if (sintPendCount_g > sintHighWater_g)
+        sintHighWater_g = sintPendCount_g;
+#endif
+    }
+    sintParam_g[intno] = param;
+    POS_IRQ_ENABLE_ALL;
+  }
+}
+
+#else /* POSCFG_SOFTINT_COALESCE */
+
 void POSCALL posSoftInt(UVAR_t intno, UVAR_t param)
 {
   UVAR_t next;
+#if POSCFG_FEATURE_SOFTINTSTATS != 0
+  UINT_t fill;
+#endif
   POS_LOCKFLAGS;
 
   P_ASSERT("posSoftInt: interrupt number", intno < POSCFG_SOFTINTERRUPTS);
@@ -2983,11 +6071,23 @@ void POSCALL posSoftInt(UVAR_t intno, UVAR_t param)
       softintqueue_g[sintIdxIn_g].intno = intno;
       softintqueue_g[sintIdxIn_g].param = param;
       sintIdxIn_g = next;    
+#if POSCFG_FEATURE_SOFTINTSTATS != 0
+      fill = (next >= sintIdxOut_g) ? (UINT_t) (next - sintIdxOut_g) :
+             (UINT_t) ((POSCFG_SOFTINTQUEUELEN + 1) - (sintIdxOut_g - next));
+      if (fill > sintHighWater_g)
+        sintHighWater_g = fill;
+    }
+    else
+    {
+      ++sintDropped_g;
+#endif
     }
     POS_IRQ_ENABLE_ALL;
   }
 }
 
+#endif /* POSCFG_SOFTINT_COALESCE */
+
 /*-------------------------------------------------------------------------*/
 
 VAR_t POSCALL posSoftIntSetHandler(UVAR_t intno, POSINTFUNC_t inthandler)
@@ -3029,6 +6129,77 @@ VAR_t POSCALL posSoftIntDelHandler(UVAR_t intno)
 
 #endif /* POSCFG_FEATURE_SOFTINTDEL */
 
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_SOFTINT_COALESCE != 0
+
+VAR_t POSCALL posSoftIntSetMerge(UVAR_t intno, POSSINTMERGEFUNC_t merge)
+{
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posSoftIntSetMerge: interrupt number",
+           intno < POSCFG_SOFTINTERRUPTS);
+  if (intno >= POSCFG_SOFTINTERRUPTS)
+    return -E_ARG;
+  POS_IRQ_DISABLE_ALL;
+  sintMerge_g[intno] = merge;
+  POS_IRQ_ENABLE_ALL;
+  return E_OK;
+}
+
+#endif /* POSCFG_SOFTINT_COALESCE */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_SOFTINTDEFER != 0
+
+VAR_t POSCALL posSoftIntDefer(POSDEFERFUNC_t func, void *arg)
+{
+  UVAR_t next;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posSoftIntDefer: function valid", func != NULL);
+  if (func == NULL)
+    return -E_ARG;
+  POS_IRQ_DISABLE_ALL;
+  next = sintDefIdxIn_g + 1;
+  if (next > POSCFG_SOFTINTDEFERLEN)
+    next = 0;
+  if (next == sintDefIdxOut_g)
+  {
+#if POSCFG_FEATURE_SOFTINTSTATS != 0
+    ++sintDropped_g;
+#endif
+    POS_IRQ_ENABLE_ALL;
+    return -E_NOMORE;
+  }
+  sintdeferqueue_g[sintDefIdxIn_g].func = func;
+  sintdeferqueue_g[sintDefIdxIn_g].arg  = arg;
+  sintDefIdxIn_g = next;
+  POS_IRQ_ENABLE_ALL;
+  return E_OK;
+}
+
+#endif /* POSCFG_FEATURE_SOFTINTDEFER */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_SOFTINTSTATS != 0
+
+UINT_t POSCALL posSoftIntDropCount(void)
+{
+  return sintDropped_g;
+}
+
+/*-------------------------------------------------------------------------*/
+
+UINT_t POSCALL posSoftIntHighWater(void)
+{
+  return sintHighWater_g;
+}
+
+#endif /* POSCFG_FEATURE_SOFTINTSTATS */
+
 #endif /* POSCFG_FEATURE_SOFTINTS */
 
 
@@ -3109,6 +6280,160 @@ INT_t POSCALL posAtomicSub(POSATOMIC_t *var, INT_t value)
 
 
 
+/*---------------------------------------------------------------------------
+ * EXPORTED FUNCTIONS:  RING BUFFERS
+ *-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_RINGBUF != 0
+
+VAR_t POSCALL posRingCreate(POSRING_t *ring, void *buffer,
+                            UINT_t elemsize, UINT_t count)
+{
+  register POSSEMA_t sema;
+
+  P_ASSERT("posRingCreate: ring valid", ring != NULL);
+  P_ASSERT("posRingCreate: buffer valid", buffer != NULL);
+  P_ASSERT("posRingCreate: count is a power of two",
+           (count != 0) && ((count & (count - 1)) == 0));
+  if ((ring == NULL) || (buffer == NULL) || (elemsize == 0) ||
+      (count == 0) || ((count & (count - 1)) != 0) ||
+      (count > ((((UINT_t)(UVAR_t) ~0) >> 1) + 1)))
+    return -E_ARG;
+
+  sema = posSemaCreate(0);
+  if (sema == NULL)
+    return -E_NOMORE;
+  POS_SETEVENTNAME(sema, "ringSem");
+
+  ring->head  = 0;
+  ring->tail  = 0;
+  ring->flag  = 0;
+  ring->mask  = (UVAR_t) (count - 1);
+  ring->esize = elemsize;
+  ring->buf   = (unsigned char*) buffer;
+  ring->sema  = sema;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL posRingDestroy(POSRING_t *ring)
+{
+  P_ASSERT("posRingDestroy: ring valid", ring != NULL);
+  if ((ring != NULL) && (ring->sema != NULL))
+  {
+    posSemaDestroy(ring->sema);
+    ring->sema = NULL;
+  }
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posRingPut(POSRING_t *ring, const void *elem)
+{
+  register const unsigned char *src = (const unsigned char*) elem;
+  register unsigned char *dst;
+  register UVAR_t head;
+  register UINT_t i;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posRingPut: ring valid", (ring != NULL) && (ring->sema != NULL));
+
+  /* The head index is written by the producer only, the tail index
+   * by the consumer only. The element must be complete in memory
+   * before the new head index becomes visible. */
+  head = ring->head;
+  if ((UVAR_t) (head - ring->tail) > ring->mask)
+    return -E_NOMORE;
+
+  dst = ring->buf + ((UINT_t) (head & ring->mask) * ring->esize);
+  for (i = 0; i < ring->esize; ++i)
+    dst[i] = src[i];
+  POS_MEMORY_BARRIER();
+  ring->head = (UVAR_t) (head + 1);
+  POS_MEMORY_BARRIER();
+
+  /* only the first element put into an empty ring wakes the consumer */
+  if (ring->flag != 0)
+  {
+    POS_SCHED_LOCK;
+    if (ring->flag != 0)
+    {
+      ring->flag = 0;
+      POS_SCHED_UNLOCK;
+      posSemaSignal(ring->sema);
+      return E_OK;
+    }
+    POS_SCHED_UNLOCK;
+  }
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posRingWait(POSRING_t *ring, void *elem, UINT_t timeoutticks)
+{
+  register unsigned char *dst = (unsigned char*) elem;
+  register const unsigned char *src;
+  register UVAR_t tail;
+  register UINT_t i;
+#if POSCFG_FEATURE_SEMAWAIT != 0
+  register VAR_t status;
+#endif
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posRingWait: ring valid", (ring != NULL) && (ring->sema != NULL));
+
+  tail = ring->tail;
+  while (ring->head == tail)
+  {
+    if ((timeoutticks == 0) || (posInInterrupt_g != 0))
+      return 1;
+
+    /* Announce the wait, then look again: an element put before the
+     * flag was set would not signal the semaphore. */
+    POS_SCHED_LOCK;
+    ring->flag = 1;
+    POS_MEMORY_BARRIER();
+    if (ring->head != tail)
+    {
+      ring->flag = 0;
+      POS_SCHED_UNLOCK;
+      break;
+    }
+    POS_SCHED_UNLOCK;
+
+#if POSCFG_FEATURE_SEMAWAIT != 0
+    status = posSemaWait(ring->sema, timeoutticks);
+    ring->flag = 0;
+    if ((status != E_OK) && (ring->head == tail))
+      return 1;
+#else
+    posSemaGet(ring->sema);
+    ring->flag = 0;
+#endif
+  }
+
+  POS_MEMORY_BARRIER();
+  src = ring->buf + ((UINT_t) (tail & ring->mask) * ring->esize);
+  for (i = 0; i < ring->esize; ++i)
+    dst[i] = src[i];
+  POS_MEMORY_BARRIER();
+  ring->tail = (UVAR_t) (tail + 1);
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posRingGet(POSRING_t *ring, void *elem)
+{
+  return posRingWait(ring, elem, INFINITE);
+}
+
+#endif /* POSCFG_FEATURE_RINGBUF */
+
+
+
 /*---------------------------------------------------------------------------
  * EXPORTED FUNCTIONS:  LISTS
  *-------------------------------------------------------------------------*/
@@ -3420,14 +6745,24 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #if SYS_FEATURE_EVENTS != 0
   EVENT_t   ev;
 #endif
-#if (POSCFG_FEATURE_MSGBOXES != 0) && (POSCFG_MAX_MESSAGES != 0)
+#if POSCFG_FEATURE_MSGBOXES != 0
+#if (MSG_COUNT != 0) || (POSCFG_MSG_SIZECLASSES > 1)
   MSGBUF_t  *mbuf;
 #endif
+#if POSCFG_MSG_SIZECLASSES > 1
+  unsigned char *msgmem;
+  UINT_t    n;
+#endif
+  UVAR_t    c;
+#endif
 #if (POSCFG_FEATURE_TIMER != 0) && (POSCFG_MAX_TIMER != 0)
   TIMER_t   *tmr;
 #endif
 #if POSCFG_DYNAMIC_MEMORY != 0
   void      *m;
+#endif
+#if (POSCFG_FEATURE_TIMER != 0) && (POSCFG_TIMER_WHEEL != 0)
+  UINT_t    w;
 #endif
   UVAR_t   i;
   POS_LOCKFLAGS;
@@ -3468,15 +6803,26 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #endif
 
 #if POSCFG_FEATURE_MSGBOXES != 0
-#if POSCFG_MAX_MESSAGES != 0
+#if POSCFG_MSG_SIZECLASSES > 1
+#if MSG_COUNT != 0
+  m = POS_MEM_ALLOC(ALIGNEDBUFSIZE(MSG_MEMSIZE, 1));
+#if POSCFG_ARGCHECK > 1
+  if (m == NULL)
+    return;
+#endif
+  msgmem = MEMALIGN(unsigned char*, m);
+#else
+  msgmem = NULL;
+#endif
+#elif POSCFG_MAX_MESSAGES != 0
   m = POS_MEM_ALLOC(ALIGNEDBUFSIZE(sizeof(MSGBUF_t), POSCFG_MAX_MESSAGES));
 #if POSCFG_ARGCHECK > 1
   if (m == NULL)
     return;
 #endif
-  posFreeMessagebuf_g = MEMALIGN(MSGBUF_t*, m);
+  posMsgClass_g[0].freebuf = MEMALIGN(MSGBUF_t*, m);
 #else
-  posFreeMessagebuf_g = NULL;
+  posMsgClass_g[0].freebuf = NULL;
 #endif
 #endif
 
@@ -3510,10 +6856,16 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #endif
 
 #if POSCFG_FEATURE_MSGBOXES != 0
-#if POSCFG_MAX_MESSAGES != 0
-  posFreeMessagebuf_g = MEMALIGN(MSGBUF_t*, posStaticMessageMem_g);
+#if POSCFG_MSG_SIZECLASSES > 1
+#if MSG_COUNT != 0
+  msgmem = MEMALIGN(unsigned char*, posStaticMessageMem_g);
+#else
+  msgmem = NULL;
+#endif
+#elif POSCFG_MAX_MESSAGES != 0
+  posMsgClass_g[0].freebuf = MEMALIGN(MSGBUF_t*, posStaticMessageMem_g);
 #else
-  posFreeMessagebuf_g = NULL;
+  posMsgClass_g[0].freebuf = NULL;
 #endif
 #endif
 
@@ -3564,17 +6916,36 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #endif
 
 #if POSCFG_FEATURE_MSGBOXES != 0
-  msgAllocWaitReq_g = 0;
-  msgAllocSyncSem_g = posSemaCreate(1);
-  msgAllocWaitSem_g = posSemaCreate(0);
-  POS_SETEVENTNAME(msgAllocSyncSem_g, "msgAllocSync");
-  POS_SETEVENTNAME(msgAllocWaitSem_g, "msgAllocWait");
-#if ((POSCFG_MAX_EVENTS + SYS_MSGBOXEVENTS) < 2) && (SYS_POSTALLOCATE != 0)
-  if ((msgAllocSyncSem_g == NULL) || (msgAllocWaitSem_g == NULL))
-    return;
+  for (c = 0; c < POSCFG_MSG_SIZECLASSES; ++c)
+  {
+    posMsgClass_g[c].waitreq = 0;
+    posMsgClass_g[c].allocsync = posSemaCreate(1);
+    posMsgClass_g[c].allocwait = posSemaCreate(0);
+    POS_SETEVENTNAME(posMsgClass_g[c].allocsync, "msgAllocSync");
+    POS_SETEVENTNAME(posMsgClass_g[c].allocwait, "msgAllocWait");
+#if ((POSCFG_MAX_EVENTS + SYS_MSGBOXEVENTS) < (2 * POSCFG_MSG_SIZECLASSES)) \
+    && (SYS_POSTALLOCATE != 0)
+    if ((posMsgClass_g[c].allocsync == NULL) ||
+        (posMsgClass_g[c].allocwait == NULL))
+      return;
+#endif
+#if POSCFG_MSG_SIZECLASSES > 1
+    posMsgClass_g[c].freebuf = NULL;
+    for (n = 0; n < posMsgClassCount_g[c]; ++n)
+    {
+      mbuf = (MSGBUF_t*) (void*) msgmem;
+#if POSCFG_ARGCHECK > 1
+      mbuf->magic = POSMAGIC_MSGBUF;
+#endif
+      mbuf->sclass = c;
+      mbuf->next = posMsgClass_g[c].freebuf;
+      posMsgClass_g[c].freebuf = mbuf;
+      msgmem += MSGBLOCKSIZE(posMsgClassSize_g[c]);
+    }
 #endif
-#if POSCFG_MAX_MESSAGES != 0
-  mbuf = posFreeMessagebuf_g;
+  }
+#if (POSCFG_MSG_SIZECLASSES == 1) && (POSCFG_MAX_MESSAGES != 0)
+  mbuf = posMsgClass_g[0].freebuf;
   for (i=0; i<POSCFG_MAX_MESSAGES-1; ++i)
   {
 #if POSCFG_ARGCHECK > 1
@@ -3591,7 +6962,23 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #endif
 
 #if POSCFG_FEATURE_TIMER != 0
+#if POSCFG_TIMER_WHEEL != 0
+  for (w = 0; w < POSCFG_TIMER_WHEEL_LEVELS * TWHEEL_SIZE; ++w)
+    (&posTimerWheel_g[0][0])[w] = NULL;
+  for (i = 0; i < POSCFG_TIMER_WHEEL_LEVELS; ++i)
+    posTimerWheelCount_g[i] = 0;
+  posTimerWheelNow_g = 0;
+#else
   posActiveTimers_g = NULL;
+#endif
+#if POSCFG_FEATURE_TIMERDAEMON != 0
+  posTimerDaemonHead_g = NULL;
+  posTimerDaemonTail_g = NULL;
+  posTimerDaemonSema_g = NULL;
+#endif
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  posHiresTimers_g = NULL;
+#endif
 #if POSCFG_MAX_TIMER != 0
   tmr = posFreeTimer_g;
 #if POSCFG_MAX_TIMER > 1
@@ -3617,24 +7004,51 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
     posNextRoundRobin_g[i] = 0;
 #endif
 #if (POSCFG_ROUNDROBIN != 0) && (SYS_TASKTABSIZE_X < MVAR_BITS)
-    posAllocatedTasks_g.xtable[i] = (UVAR_t) ~((1 << SYS_TASKTABSIZE_X) - 1);
+    posAllocatedTasks_g.xtable[i] = (UVAR_t) ~(pos_shift1l(SYS_TASKTABSIZE_X) - 1);
 #else
     posAllocatedTasks_g.xtable[i] = 0;
 #endif
     posReadyTasks_g.xtable[i] = 0;
   }
-#if SYS_TASKTABSIZE_Y > 1
+#if SYS_TASKTABSIZE_Z > 1
+  for (i=0; i<SYS_TASKTABSIZE_Z; ++i)
+  {
+    posAllocatedTasks_g.ymask[i] = 0;
+    posReadyTasks_g.ymask[i] = 0;
+  }
+  posAllocatedTasks_g.zmask = 0;
+  posReadyTasks_g.zmask = 0;
+#elif SYS_TASKTABSIZE_Y > 1
   posAllocatedTasks_g.ymask = 0;
   posReadyTasks_g.ymask = 0;
 #endif
 
 #if POSCFG_FEATURE_SOFTINTS != 0
+#if POSCFG_SOFTINT_COALESCE != 0
+  for (i=0; i<SYS_SINTWORDS; i++)
+  {
+    sintPending_g[i] = 0;
+  }
+  sintPendCount_g = 0;
+#else
   sintIdxIn_g = 0;
   sintIdxOut_g = 0;
+#endif
   for (i=0; i<POSCFG_SOFTINTERRUPTS; i++)
   {
     softIntHandlers_g[i] = NULL;
+#if POSCFG_SOFTINT_COALESCE != 0
+    sintMerge_g[i] = NULL;
+#endif
   }
+#if POSCFG_FEATURE_SOFTINTDEFER != 0
+  sintDefIdxIn_g = 0;
+  sintDefIdxOut_g = 0;
+#endif
+#if POSCFG_FEATURE_SOFTINTSTATS != 0
+  sintDropped_g = 0;
+  sintHighWater_g = 0;
+#endif
 #endif
 #if POSCFG_CTXSW_COMBINE > 1
   posCtxCombineCtr_g = 0;
@@ -3645,6 +7059,12 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
   posMustSchedule_g = 0;
   posInInterrupt_g  = 1;
   posSleepingTasks_g   = NULL;
+#if POSCFG_FEATURE_HIRESTIMER != 0
+  posHiresTasks_g      = NULL;
+#endif
+#if POSCFG_FEATURE_BUDGET != 0
+  posThrottledTasks_g  = NULL;
+#endif
 #if POSCFG_FEATURE_JIFFIES != 0
 #if POSCFG_FEATURE_LARGEJIFFIES == 0
   jiffies = 0;